@@ -0,0 +1,23 @@
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+
+/*
+ * Just enough MD5 and AES-128 to read figure data. Both are small byte
+ * oriented versions, figures only need a handful of blocks at a time.
+ */
+
+#define POF_MD5_SIZE 16
+#define POF_AES_BLOCK_SIZE 16
+#define POF_AES_KEY_SIZE 16
+
+typedef struct {
+    uint8_t round_keys[11][POF_AES_BLOCK_SIZE];
+} PoFAesKey;
+
+void pof_md5(const uint8_t* input, size_t size, uint8_t output[POF_MD5_SIZE]);
+
+void pof_aes128_set_key(PoFAesKey* key, const uint8_t raw[POF_AES_KEY_SIZE]);
+// ECB, input and output may be the same buffer
+void pof_aes128_decrypt(const PoFAesKey* key, const uint8_t* input, uint8_t* output);
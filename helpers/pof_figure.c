@@ -0,0 +1,430 @@
+#include "pof_figure.h"
+
+#include "pof_probe.h"
+
+#define TAG "PoFFigure"
+
+#define POF_FIGURE_BLOCK_SIZE 16
+// Checks per data area, types 1 to 3
+#define POF_FIGURE_AREA_CHECKS 3
+
+static const uint8_t pof_figure_area_start[POF_FIGURE_AREA_COUNT] = {0x08, 0x24};
+// Skips the sector trailer in the middle of each area
+static const uint8_t pof_figure_area_offset[POF_FIGURE_AREA_BLOCKS] = {0, 1, 2, 4};
+// Blocks covered by the type 2 and type 3 checksums, relative to the area
+static const uint8_t pof_figure_type2_offset[] = {1, 2, 4};
+static const uint8_t pof_figure_type3_offset[] = {5, 6, 8, 9};
+// Type 3 carries on over this many zeros after its blocks
+#define POF_FIGURE_TYPE3_PADDING 0xE0
+
+// Appended to blocks 0 and 1 and the block number to make each block's key
+static const char pof_figure_key_suffix[] =
+    " Copyright (C) 2010 Activision. All Rights Reserved. ";
+
+// Experience needed for each level, Spyro's Adventure stops at 10
+static const uint32_t pof_figure_levels[] =
+    {0, 1000, 2200, 3800, 6000, 9000, 13000, 18200, 24800, 33000};
+
+static const char* const pof_figure_type_names[] = {
+    [PoFFigureTypeUnknown] = "Unknown",
+    [PoFFigureTypeSkylander] = "Skylander",
+    [PoFFigureTypeTrap] = "Trap",
+    [PoFFigureTypeItem] = "Item",
+    [PoFFigureTypeAdventure] = "Adventure",
+    [PoFFigureTypeVehicle] = "Vehicle",
+};
+
+static const char* const pof_figure_check_names[] = {
+    "hdr",
+    "a0t1",
+    "a0t2",
+    "a0t3",
+    "a1t1",
+    "a1t2",
+    "a1t3",
+};
+
+// CRC-16/CCITT-FALSE, a nibble at a time
+static const uint16_t pof_figure_crc_table[16] = {
+    0x0000,
+    0x1021,
+    0x2042,
+    0x3063,
+    0x4084,
+    0x50a5,
+    0x60c6,
+    0x70e7,
+    0x8108,
+    0x9129,
+    0xa14a,
+    0xb16b,
+    0xc18c,
+    0xd1ad,
+    0xe1ce,
+    0xf1ef,
+};
+
+static uint16_t pof_figure_crc16(uint16_t crc, const uint8_t* data, size_t size) {
+    for (size_t i = 0; i < size; i++) {
+        crc = (crc << 4) ^ pof_figure_crc_table[(crc >> 12) ^ (data[i] >> 4)];
+        crc = (crc << 4) ^ pof_figure_crc_table[(crc >> 12) ^ (data[i] & 0x0F)];
+    }
+    return crc;
+}
+
+static uint16_t pof_figure_u16(const uint8_t* data) {
+    return data[0] | (data[1] << 8);
+}
+
+static bool pof_figure_blank(const uint8_t* block) {
+    for (size_t i = 0; i < POF_FIGURE_BLOCK_SIZE; i++) {
+        if (block[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static PoFFigureType pof_figure_type(uint16_t character_id) {
+    if (character_id >= 200 && character_id < 210) {
+        return PoFFigureTypeItem;
+    } else if (character_id >= 210 && character_id < 230) {
+        return PoFFigureTypeTrap;
+    } else if (character_id >= 230 && character_id < 300) {
+        return PoFFigureTypeItem;
+    } else if (character_id >= 300 && character_id < 400) {
+        return PoFFigureTypeAdventure;
+    } else if (character_id >= 3200 && character_id < 3300) {
+        return PoFFigureTypeVehicle;
+    } else if (character_id < 4000) {
+        return PoFFigureTypeSkylander;
+    }
+    return PoFFigureTypeUnknown;
+}
+
+static void pof_figure_derive_key(const MfClassicData* data, uint8_t block, uint8_t* key) {
+    uint8_t input[POF_FIGURE_BLOCK_SIZE * 2 + 1 + sizeof(pof_figure_key_suffix) - 1];
+    memcpy(input, data->block[0].data, POF_FIGURE_BLOCK_SIZE);
+    memcpy(input + POF_FIGURE_BLOCK_SIZE, data->block[1].data, POF_FIGURE_BLOCK_SIZE);
+    input[POF_FIGURE_BLOCK_SIZE * 2] = block;
+    memcpy(
+        input + POF_FIGURE_BLOCK_SIZE * 2 + 1,
+        pof_figure_key_suffix,
+        sizeof(pof_figure_key_suffix) - 1);
+    pof_md5(input, sizeof(input), key);
+}
+
+static void pof_figure_derive_keys(PoFFigure* figure, const MfClassicData* data) {
+    for (size_t area = 0; area < POF_FIGURE_AREA_COUNT; area++) {
+        for (size_t i = 0; i < POF_FIGURE_AREA_BLOCKS; i++) {
+            pof_figure_derive_key(
+                data, pof_figure_area_start[area] + pof_figure_area_offset[i], figure->keys[area][i]);
+        }
+    }
+    figure->keys_valid = true;
+}
+
+// Returns the area index and its position for a block, false when it isn't decoded
+static bool pof_figure_area_block(uint8_t block, uint8_t* area, uint8_t* index) {
+    for (uint8_t a = 0; a < POF_FIGURE_AREA_COUNT; a++) {
+        for (uint8_t i = 0; i < POF_FIGURE_AREA_BLOCKS; i++) {
+            if (pof_figure_area_start[a] + pof_figure_area_offset[i] == block) {
+                *area = a;
+                *index = i;
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+// Decoded blocks use the cached keys, the rest are only needed for checksums and derived here
+static void pof_figure_decrypt(
+    PoFFigure* figure,
+    const MfClassicData* data,
+    uint8_t block,
+    uint8_t* out) {
+    const uint8_t* encrypted = data->block[block].data;
+    // Blocks that were never written are left as zeros rather than encrypted
+    if (pof_figure_blank(encrypted)) {
+        memset(out, 0, POF_FIGURE_BLOCK_SIZE);
+        return;
+    }
+    uint8_t derived[POF_AES_KEY_SIZE];
+    const uint8_t* raw = derived;
+    uint8_t area;
+    uint8_t index;
+    if (figure->keys_valid && pof_figure_area_block(block, &area, &index)) {
+        raw = figure->keys[area][index];
+    } else {
+        pof_figure_derive_key(data, block, derived);
+    }
+    PoFAesKey key;
+    pof_aes128_set_key(&key, raw);
+    pof_aes128_decrypt(&key, encrypted, out);
+}
+
+static void pof_figure_decode_header(PoFFigureInfo* info, const MfClassicData* data) {
+    const uint8_t* block = data->block[1].data;
+    info->character_id = pof_figure_u16(block);
+    info->variant = pof_figure_u16(block + 0x0C);
+    info->type = pof_figure_type(info->character_id);
+    info->valid = true;
+}
+
+static void pof_figure_decode_nickname(char* nickname, const uint8_t* first, const uint8_t* second) {
+    size_t length = 0;
+    for (size_t i = 0; i < POF_FIGURE_NICKNAME_LEN - 1; i++) {
+        const uint8_t* half = i < 8 ? first : second;
+        uint16_t c = pof_figure_u16(half + (i % 8) * 2);
+        if (c == 0) {
+            break;
+        }
+        nickname[length++] = c < 0x20 || c > 0x7E ? '?' : c;
+    }
+    nickname[length] = '\0';
+}
+
+static void pof_figure_decode_area(PoFFigure* figure, const MfClassicData* data) {
+    PoFFigureInfo* info = &figure->info;
+    uint8_t headers[POF_FIGURE_AREA_COUNT][POF_FIGURE_BLOCK_SIZE];
+    bool blanks[POF_FIGURE_AREA_COUNT];
+    for (uint8_t area = 0; area < POF_FIGURE_AREA_COUNT; area++) {
+        pof_figure_decrypt(figure, data, pof_figure_area_start[area], headers[area]);
+        blanks[area] = pof_figure_blank(headers[area]);
+    }
+
+    // The sequence byte goes up by one each save, so the newer area is ahead by wrapping compare
+    int8_t ahead = headers[1][0x09] - headers[0][0x09];
+    uint8_t area = blanks[0] || (!blanks[1] && ahead > 0) ? 1 : 0;
+    const uint8_t* header = headers[area];
+    uint8_t start = pof_figure_area_start[area];
+
+    memset(info->nickname, 0, sizeof(info->nickname));
+    info->area = area;
+    info->area_valid = !blanks[area];
+    info->experience = 0;
+    info->level = 0;
+    info->gold = 0;
+    info->hat = 0;
+    if (blanks[area]) {
+        return;
+    }
+
+    uint8_t block[POF_FIGURE_BLOCK_SIZE];
+    uint8_t nickname[POF_FIGURE_BLOCK_SIZE];
+    info->experience = header[0] | (header[1] << 8) | (header[2] << 16);
+    info->gold = pof_figure_u16(header + 0x03);
+    for (size_t level = 0; level < COUNT_OF(pof_figure_levels); level++) {
+        if (info->experience >= pof_figure_levels[level]) {
+            info->level = level + 1;
+        }
+    }
+    pof_figure_decrypt(figure, data, start + 1, block);
+    info->hat = pof_figure_u16(block + 0x04);
+    pof_figure_decrypt(figure, data, start + 2, nickname);
+    pof_figure_decrypt(figure, data, start + 4, block);
+    pof_figure_decode_nickname(info->nickname, nickname, block);
+}
+
+static uint16_t pof_figure_crc_blocks(
+    PoFFigure* figure,
+    const MfClassicData* data,
+    uint8_t start,
+    const uint8_t* offsets,
+    size_t count) {
+    uint16_t crc = 0xFFFF;
+    uint8_t block[POF_FIGURE_BLOCK_SIZE];
+    for (size_t i = 0; i < count; i++) {
+        pof_figure_decrypt(figure, data, start + offsets[i], block);
+        crc = pof_figure_crc16(crc, block, POF_FIGURE_BLOCK_SIZE);
+    }
+    return crc;
+}
+
+static bool pof_figure_check(PoFFigure* figure, const MfClassicData* data, uint8_t bit) {
+    if (bit == 0) {
+        uint8_t header[POF_FIGURE_BLOCK_SIZE * 2];
+        memcpy(header, data->block[0].data, POF_FIGURE_BLOCK_SIZE);
+        memcpy(header + POF_FIGURE_BLOCK_SIZE, data->block[1].data, POF_FIGURE_BLOCK_SIZE);
+        return pof_figure_crc16(0xFFFF, header, 0x1E) == pof_figure_u16(header + 0x1E);
+    }
+
+    uint8_t area = (bit - 1) / POF_FIGURE_AREA_CHECKS;
+    uint8_t type = (bit - 1) % POF_FIGURE_AREA_CHECKS + 1;
+    uint8_t start = pof_figure_area_start[area];
+    uint8_t header[POF_FIGURE_BLOCK_SIZE];
+    pof_figure_decrypt(figure, data, start, header);
+    if (pof_figure_blank(header)) {
+        // Never written by a game, nothing to check
+        return true;
+    }
+
+    uint16_t crc = 0xFFFF;
+    uint16_t expected = 0;
+    if (type == 1) {
+        // Computed with its own field holding 0x0005
+        expected = pof_figure_u16(header + 0x0E);
+        header[0x0E] = 0x05;
+        header[0x0F] = 0x00;
+        crc = pof_figure_crc16(crc, header, POF_FIGURE_BLOCK_SIZE);
+    } else if (type == 2) {
+        expected = pof_figure_u16(header + 0x0C);
+        crc = pof_figure_crc_blocks(
+            figure, data, start, pof_figure_type2_offset, COUNT_OF(pof_figure_type2_offset));
+    } else {
+        expected = pof_figure_u16(header + 0x0A);
+        crc = pof_figure_crc_blocks(
+            figure, data, start, pof_figure_type3_offset, COUNT_OF(pof_figure_type3_offset));
+        uint8_t zeros[POF_FIGURE_BLOCK_SIZE] = {0};
+        for (size_t i = 0; i < POF_FIGURE_TYPE3_PADDING; i += POF_FIGURE_BLOCK_SIZE) {
+            crc = pof_figure_crc16(crc, zeros, POF_FIGURE_BLOCK_SIZE);
+        }
+    }
+    return crc == expected;
+}
+
+// Checksums that include the block or are stored in it
+static uint8_t pof_figure_block_checks(uint8_t block) {
+    if (block <= 1) {
+        // The keys for every area block come from these too
+        return PoFFigureCheckAll;
+    }
+    for (uint8_t area = 0; area < POF_FIGURE_AREA_COUNT; area++) {
+        uint8_t type1 = PoFFigureCheckArea0Type1 << (area * POF_FIGURE_AREA_CHECKS);
+        uint8_t offset = block - pof_figure_area_start[area];
+        if (offset == 0) {
+            return type1 | (type1 << 1) | (type1 << 2);
+        }
+        for (size_t i = 0; i < COUNT_OF(pof_figure_type2_offset); i++) {
+            if (offset == pof_figure_type2_offset[i]) {
+                return type1 << 1;
+            }
+        }
+        for (size_t i = 0; i < COUNT_OF(pof_figure_type3_offset); i++) {
+            if (offset == pof_figure_type3_offset[i]) {
+                return type1 << 2;
+            }
+        }
+    }
+    return 0;
+}
+
+static void pof_figure_begin(PoFFigure* figure) {
+    uint32_t seq = figure->seq;
+    __atomic_store_n(&figure->seq, seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+static void pof_figure_end(PoFFigure* figure) {
+    __atomic_store_n(&figure->seq, figure->seq + 1, __ATOMIC_RELEASE);
+}
+
+void pof_figure_reset(PoFFigure* figure) {
+    pof_figure_begin(figure);
+    memset(&figure->info, 0, sizeof(figure->info));
+    figure->keys_valid = false;
+    pof_figure_end(figure);
+}
+
+void pof_figure_load(PoFFigure* figure, const MfClassicData* data) {
+    pof_figure_begin(figure);
+    memset(&figure->info, 0, sizeof(figure->info));
+    pof_figure_decode_header(&figure->info, data);
+    pof_figure_derive_keys(figure, data);
+    pof_figure_decode_area(figure, data);
+    for (uint8_t bit = 0; (1 << bit) & PoFFigureCheckAll; bit++) {
+        if (!pof_figure_check(figure, data, bit)) {
+            figure->info.checks_failed |= 1 << bit;
+        }
+    }
+    pof_figure_end(figure);
+    if (figure->info.checks_failed) {
+        FuriString* failed = furi_string_alloc();
+        pof_figure_checks_format(failed, figure->info.checks_failed);
+        FURI_LOG_W(TAG, "Bad checksums: %s", furi_string_get_cstr(failed));
+        furi_string_free(failed);
+    }
+}
+
+void pof_figure_write(PoFFigure* figure, const MfClassicData* data, uint8_t block) {
+    uint8_t area;
+    uint8_t index;
+    uint8_t checks = pof_figure_block_checks(block);
+    bool decoded = pof_figure_area_block(block, &area, &index);
+    if (!checks && !decoded) {
+        return;
+    }
+    pof_figure_begin(figure);
+    if (block <= 1) {
+        FURI_LOG_D(TAG, "Block %d written, deriving keys again", block);
+        pof_figure_decode_header(&figure->info, data);
+        pof_figure_derive_keys(figure, data);
+        decoded = true;
+    }
+    if (decoded) {
+        pof_figure_decode_area(figure, data);
+    }
+    figure->info.checks_pending |= checks;
+    figure->written_at = furi_get_tick();
+    pof_figure_end(figure);
+}
+
+uint32_t pof_figure_verify_wait(const PoFFigure* figure, uint32_t now) {
+    if (!figure->info.checks_pending) {
+        return FuriWaitForever;
+    }
+    uint32_t quiet = now - figure->written_at;
+    return quiet < POF_FIGURE_VERIFY_DELAY ? POF_FIGURE_VERIFY_DELAY - quiet : 0;
+}
+
+void pof_figure_verify_step(PoFFigure* figure, const MfClassicData* data) {
+    uint8_t pending = figure->info.checks_pending;
+    if (!pending) {
+        return;
+    }
+
+    uint8_t bit = __builtin_ctz(pending);
+    uint32_t probe_start = pof_probe_start();
+    bool ok = pof_figure_check(figure, data, bit);
+    pof_probe_end(PoFProbeFigureVerify, probe_start);
+
+    pof_figure_begin(figure);
+    figure->info.checks_pending &= ~(1 << bit);
+    if (ok) {
+        figure->info.checks_failed &= ~(1 << bit);
+    } else {
+        figure->info.checks_failed |= 1 << bit;
+    }
+    pof_figure_end(figure);
+    if (!ok) {
+        FURI_LOG_W(TAG, "Bad checksum after write: %s", pof_figure_check_names[bit]);
+    }
+}
+
+void pof_figure_get(const PoFFigure* figure, PoFFigureInfo* info) {
+    while (true) {
+        uint32_t seq = __atomic_load_n(&figure->seq, __ATOMIC_ACQUIRE);
+        if (seq & 1) {
+            furi_thread_yield();
+            continue;
+        }
+        *info = figure->info;
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&figure->seq, __ATOMIC_RELAXED) == seq) {
+            return;
+        }
+    }
+}
+
+const char* pof_figure_type_name(PoFFigureType type) {
+    return type < COUNT_OF(pof_figure_type_names) ? pof_figure_type_names[type] : "?";
+}
+
+void pof_figure_checks_format(FuriString* out, uint8_t checks) {
+    for (size_t bit = 0; bit < COUNT_OF(pof_figure_check_names); bit++) {
+        if (checks & (1 << bit)) {
+            furi_string_cat_printf(out, furi_string_size(out) ? " %s" : "%s", pof_figure_check_names[bit]);
+        }
+    }
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <furi.h>
+#include <lib/nfc/protocols/mf_classic/mf_classic.h>
+
+#include "pof_crypto.h"
+
+// 16 UTF-16 characters on the figure, kept as ASCII
+#define POF_FIGURE_NICKNAME_LEN 17
+
+// Two copies of the data area, the game writes to the older one
+#define POF_FIGURE_AREA_COUNT 2
+// Blocks of an area that are decoded, relative to its first block
+#define POF_FIGURE_AREA_BLOCKS 4
+
+// Checksums are left alone until writes to the figure have been quiet for this long
+#define POF_FIGURE_VERIFY_DELAY 200
+
+/*
+ * Checksummed regions, one bit each. Type 0 covers blocks 0 and 1, each data area
+ * has type 1 (its header), type 2 (the next 0x30 bytes) and type 3 (the 0x40 after that).
+ */
+typedef enum {
+    PoFFigureCheckHeader = (1 << 0),
+    PoFFigureCheckArea0Type1 = (1 << 1),
+    PoFFigureCheckArea0Type2 = (1 << 2),
+    PoFFigureCheckArea0Type3 = (1 << 3),
+    PoFFigureCheckArea1Type1 = (1 << 4),
+    PoFFigureCheckArea1Type2 = (1 << 5),
+    PoFFigureCheckArea1Type3 = (1 << 6),
+
+    PoFFigureCheckAll = (1 << 7) - 1,
+} PoFFigureCheck;
+
+typedef enum {
+    PoFFigureTypeUnknown,
+    PoFFigureTypeSkylander,
+    PoFFigureTypeTrap,
+    PoFFigureTypeItem,
+    PoFFigureTypeAdventure,
+    PoFFigureTypeVehicle,
+} PoFFigureType;
+
+typedef struct {
+    // Header from block 1, which isn't encrypted
+    bool valid;
+    uint16_t character_id;
+    uint16_t variant;
+    PoFFigureType type;
+    // Active data area, false for a figure that has never been played
+    bool area_valid;
+    uint8_t area;
+    uint32_t experience;
+    uint8_t level;
+    uint16_t gold;
+    uint16_t hat;
+    char nickname[POF_FIGURE_NICKNAME_LEN];
+    // PoFFigureCheck bits waiting to be verified, and those that failed last time
+    uint8_t checks_pending;
+    uint8_t checks_failed;
+} PoFFigureInfo;
+
+/*
+ * Decoded figure data, kept with the token so it isn't decrypted again for every
+ * redraw. Only a write to block 0 or 1 (which the keys come from) or to one of the
+ * decoded data area blocks updates it.
+ */
+typedef struct {
+    // Odd while the USB thread is updating info
+    uint32_t seq;
+    PoFFigureInfo info;
+    bool keys_valid;
+    uint8_t keys[POF_FIGURE_AREA_COUNT][POF_FIGURE_AREA_BLOCKS][POF_AES_KEY_SIZE];
+    // Tick of the last write, for the verify delay
+    uint32_t written_at;
+} PoFFigure;
+
+void pof_figure_reset(PoFFigure* figure);
+// Decodes and verifies everything, keys included
+void pof_figure_load(PoFFigure* figure, const MfClassicData* data);
+// data already holds the written block. Marks the checksums covering it as pending.
+void pof_figure_write(PoFFigure* figure, const MfClassicData* data, uint8_t block);
+// Ticks until pending checksums are due, 0 once writes have been quiet for
+// POF_FIGURE_VERIFY_DELAY, FuriWaitForever when nothing is pending
+uint32_t pof_figure_verify_wait(const PoFFigure* figure, uint32_t now);
+// Verifies one pending region, from the thread that writes the figure
+void pof_figure_verify_step(PoFFigure* figure, const MfClassicData* data);
+// Consistent copy while another thread may be writing
+void pof_figure_get(const PoFFigure* figure, PoFFigureInfo* info);
+
+const char* pof_figure_type_name(PoFFigureType type);
+// Names every bit in checks, space separated
+void pof_figure_checks_format(FuriString* out, uint8_t checks);
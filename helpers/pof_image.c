@@ -0,0 +1,172 @@
+#include "pof_image.h"
+
+#define TAG "PoFImage"
+
+struct PoFImage {
+    PoFImage* next;
+    NfcDevice* nfc_device;
+    // Held while the data is changed or saved, so a save never sees half a write
+    FuriMutex* lock;
+    uint32_t refs;
+    uint32_t hash;
+};
+
+// Every image in use, and the counters below, are guarded by the mutex. Taken before an image lock.
+static FuriMutex* pof_image_mutex = NULL;
+static PoFImage* pof_image_list = NULL;
+static uint32_t pof_image_shared = 0;
+static uint32_t pof_image_copies = 0;
+
+// FNV-1a over the blocks, only to skip the full compare for most images
+static uint32_t pof_image_hash(const MfClassicData* data) {
+    uint32_t hash = 2166136261u;
+    uint16_t blocks = mf_classic_get_total_block_num(data->type);
+    for (uint16_t i = 0; i < blocks; i++) {
+        for (size_t j = 0; j < MF_CLASSIC_BLOCK_SIZE; j++) {
+            hash = (hash ^ data->block[i].data[j]) * 16777619u;
+        }
+    }
+    return hash;
+}
+
+static PoFImage* pof_image_alloc(NfcDevice* nfc_device, uint32_t hash) {
+    PoFImage* image = malloc(sizeof(PoFImage));
+    image->nfc_device = nfc_device;
+    image->lock = furi_mutex_alloc(FuriMutexTypeNormal);
+    image->refs = 1;
+    image->hash = hash;
+    image->next = pof_image_list;
+    pof_image_list = image;
+    return image;
+}
+
+void pof_image_init(void) {
+    furi_assert(!pof_image_mutex);
+    pof_image_mutex = furi_mutex_alloc(FuriMutexTypeNormal);
+    pof_image_list = NULL;
+    pof_image_shared = 0;
+    pof_image_copies = 0;
+}
+
+void pof_image_deinit(void) {
+    furi_assert(pof_image_mutex);
+    if (pof_image_list) {
+        FURI_LOG_W(TAG, "Images still in use");
+    }
+    furi_mutex_free(pof_image_mutex);
+    pof_image_mutex = NULL;
+}
+
+PoFImage* pof_image_acquire(NfcDevice* nfc_device) {
+    furi_assert(nfc_device);
+    const MfClassicData* data = nfc_device_get_data(nfc_device, NfcProtocolMfClassic);
+    uint32_t hash = pof_image_hash(data);
+
+    furi_mutex_acquire(pof_image_mutex, FuriWaitForever);
+    PoFImage* image = pof_image_list;
+    while (image && (image->hash != hash ||
+                     !mf_classic_is_equal(pof_image_get_data(image), data))) {
+        image = image->next;
+    }
+    if (image) {
+        image->refs++;
+        pof_image_shared++;
+    } else {
+        image = pof_image_alloc(nfc_device, hash);
+        nfc_device = NULL;
+    }
+    furi_mutex_release(pof_image_mutex);
+
+    if (nfc_device) {
+        nfc_device_free(nfc_device);
+    }
+    return image;
+}
+
+PoFImage* pof_image_ref(PoFImage* image) {
+    furi_assert(image);
+    furi_mutex_acquire(pof_image_mutex, FuriWaitForever);
+    image->refs++;
+    furi_mutex_release(pof_image_mutex);
+    return image;
+}
+
+void pof_image_release(PoFImage* image) {
+    furi_assert(image);
+    furi_mutex_acquire(pof_image_mutex, FuriWaitForever);
+    furi_assert(image->refs);
+    bool last = --image->refs == 0;
+    if (last) {
+        PoFImage** link = &pof_image_list;
+        while (*link != image) {
+            link = &(*link)->next;
+        }
+        *link = image->next;
+    }
+    furi_mutex_release(pof_image_mutex);
+
+    if (last) {
+        nfc_device_free(image->nfc_device);
+        furi_mutex_free(image->lock);
+        free(image);
+    }
+}
+
+const MfClassicData* pof_image_get_data(const PoFImage* image) {
+    furi_assert(image);
+    return nfc_device_get_data(image->nfc_device, NfcProtocolMfClassic);
+}
+
+const MfClassicData* pof_image_write(PoFImage** image, uint8_t block, const uint8_t* data) {
+    furi_assert(image && *image);
+    PoFImage* current = *image;
+    MfClassicData* copy = mf_classic_alloc();
+
+    furi_mutex_acquire(pof_image_mutex, FuriWaitForever);
+    nfc_device_copy_data(current->nfc_device, NfcProtocolMfClassic, copy);
+    memcpy(copy->block[block].data, data, MF_CLASSIC_BLOCK_SIZE);
+    uint32_t hash = pof_image_hash(copy);
+    PoFImage* target = current;
+    if (current->refs > 1) {
+        // Other slots keep what they had
+        current->refs--;
+        target = pof_image_alloc(nfc_device_alloc(), hash);
+        pof_image_copies++;
+    }
+    furi_mutex_acquire(target->lock, FuriWaitForever);
+    nfc_device_set_data(target->nfc_device, NfcProtocolMfClassic, copy);
+    furi_mutex_release(target->lock);
+    target->hash = hash;
+    furi_mutex_release(pof_image_mutex);
+
+    mf_classic_free(copy);
+    *image = target;
+    return pof_image_get_data(target);
+}
+
+bool pof_image_save(PoFImage* image, const char* path) {
+    furi_assert(image);
+    // Only this image's lock, loads and writes to other images go on during the SD write
+    furi_mutex_acquire(image->lock, FuriWaitForever);
+    bool ok = nfc_device_save(image->nfc_device, path);
+    furi_mutex_release(image->lock);
+    return ok;
+}
+
+void pof_image_format(FuriString* out) {
+    uint32_t images = 0;
+    uint32_t refs = 0;
+    furi_mutex_acquire(pof_image_mutex, FuriWaitForever);
+    for (PoFImage* image = pof_image_list; image; image = image->next) {
+        images++;
+        refs += image->refs;
+    }
+    furi_string_cat_printf(
+        out,
+        "images %lu for %lu refs\nshared %lu copied %lu\n",
+        images,
+        refs,
+        pof_image_shared,
+        pof_image_copies);
+    furi_mutex_release(pof_image_mutex);
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include <furi.h>
+#include <lib/nfc/nfc_device.h>
+#include <lib/nfc/protocols/mf_classic/mf_classic.h>
+
+/*
+ * Card data shared between tokens. Loading a figure that is already on the portal,
+ * from the same file or another dump with the same contents, takes a reference to
+ * the existing image instead of keeping a second copy. A write to an image that is
+ * shared gives the writer its own copy first, the other slots keep the old contents.
+ */
+typedef struct PoFImage PoFImage;
+
+// Around every use of images, before the first token is loaded and after the last is cleared
+void pof_image_init(void);
+void pof_image_deinit(void);
+
+// Takes ownership of nfc_device, which must hold Mifare Classic data
+PoFImage* pof_image_acquire(NfcDevice* nfc_device);
+PoFImage* pof_image_ref(PoFImage* image);
+void pof_image_release(PoFImage* image);
+
+const MfClassicData* pof_image_get_data(const PoFImage* image);
+
+// Only from the USB worker. Updates *image when it had to be copied and returns its new data.
+const MfClassicData* pof_image_write(PoFImage** image, uint8_t block, const uint8_t* data);
+// Waits for a write to this image in progress, but not for anything on other images
+bool pof_image_save(PoFImage* image, const char* path);
+
+void pof_image_format(FuriString* out);
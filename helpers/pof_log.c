@@ -0,0 +1,129 @@
+#include "pof_log.h"
+
+#include "pof_mem.h"
+
+#define TAG "VirtualPortal"
+
+#define POF_LOG_STACK_SIZE 1024
+
+// Power of two, so the running indexes can wrap
+#define POF_LOG_RING_SIZE 32
+
+typedef enum {
+    PoFLogEventExit = (1 << 0),
+    PoFLogEventData = (1 << 1),
+} PoFLogEvent;
+
+typedef struct {
+    char command;
+    uint8_t slot;
+    uint8_t block;
+    bool has_data;
+    uint8_t data[POF_LOG_DATA_SIZE];
+} PoFLogEntry;
+
+static PoFLogEntry pof_log_ring[POF_LOG_RING_SIZE];
+// head is only written by the producer, tail only by the formatter
+static uint32_t pof_log_head = 0;
+static uint32_t pof_log_tail = 0;
+static uint32_t pof_log_dropped = 0;
+static FuriThread* pof_log_thread = NULL;
+
+void pof_log_command(char command, uint8_t slot, uint8_t block, const uint8_t* data) {
+    if (!pof_log_thread || furi_log_get_level() < FuriLogLevelInfo) {
+        return;
+    }
+    uint32_t head = pof_log_head;
+    uint32_t tail = __atomic_load_n(&pof_log_tail, __ATOMIC_ACQUIRE);
+    if (head - tail == POF_LOG_RING_SIZE) {
+        pof_log_dropped++;
+        return;
+    }
+    PoFLogEntry* entry = &pof_log_ring[head % POF_LOG_RING_SIZE];
+    entry->command = command;
+    entry->slot = slot;
+    entry->block = block;
+    entry->has_data = data != NULL;
+    if (data) {
+        memcpy(entry->data, data, POF_LOG_DATA_SIZE);
+    }
+    __atomic_store_n(&pof_log_head, head + 1, __ATOMIC_SEQ_CST);
+    // The formatter drains until it sees no more, so it only needs waking once it has caught up
+    if (__atomic_load_n(&pof_log_tail, __ATOMIC_SEQ_CST) == head) {
+        furi_thread_flags_set(furi_thread_get_id(pof_log_thread), PoFLogEventData);
+    }
+}
+
+static void pof_log_print(const PoFLogEntry* entry) {
+    char display[POF_LOG_DATA_SIZE * 2 + 1] = {0};
+    if (entry->has_data) {
+        for (size_t i = 0; i < POF_LOG_DATA_SIZE; i++) {
+            snprintf(display + (i * 2), sizeof(display) - (i * 2), "%02x", entry->data[i]);
+        }
+    }
+    switch (entry->command) {
+        case 'Q':
+            FURI_LOG_I(TAG, "Query %d %d", entry->slot, entry->block);
+            break;
+        case 'W':
+            FURI_LOG_I(TAG, "Write %d %d %s", entry->slot, entry->block, display);
+            break;
+        case 'S':
+            FURI_LOG_I(TAG, "> S %s", display);
+            break;
+        default:
+            FURI_LOG_I(TAG, "%c %d %d %s", entry->command, entry->slot, entry->block, display);
+            break;
+    }
+}
+
+static int32_t pof_log_worker(void* context) {
+    UNUSED(context);
+    pof_mem_thread_enter(PoFMemThreadLog, POF_LOG_STACK_SIZE);
+    uint32_t dropped = 0;
+    while (true) {
+        uint32_t flags = furi_thread_flags_wait(
+            PoFLogEventExit | PoFLogEventData, FuriFlagWaitAny, FuriWaitForever);
+        if (flags & FuriFlagError) {
+            continue;
+        }
+        while (pof_log_tail != __atomic_load_n(&pof_log_head, __ATOMIC_SEQ_CST)) {
+            pof_log_print(&pof_log_ring[pof_log_tail % POF_LOG_RING_SIZE]);
+            __atomic_store_n(&pof_log_tail, pof_log_tail + 1, __ATOMIC_SEQ_CST);
+        }
+        uint32_t dropped_now = pof_log_dropped;
+        if (dropped_now != dropped) {
+            FURI_LOG_W(TAG, "%lu log entries dropped", dropped_now - dropped);
+            dropped = dropped_now;
+        }
+        if (flags & PoFLogEventExit) {
+            break;
+        }
+    }
+    pof_mem_thread_exit(PoFMemThreadLog);
+    return 0;
+}
+
+void pof_log_start(void) {
+    if (pof_log_thread) {
+        return;
+    }
+    pof_log_head = 0;
+    pof_log_tail = 0;
+    pof_log_dropped = 0;
+    FuriThread* thread = furi_thread_alloc_ex("PoFLogWorker", POF_LOG_STACK_SIZE, pof_log_worker, NULL);
+    furi_thread_set_priority(thread, FuriThreadPriorityLowest);
+    furi_thread_start(thread);
+    pof_log_thread = thread;
+}
+
+void pof_log_stop(void) {
+    if (!pof_log_thread) {
+        return;
+    }
+    FuriThread* thread = pof_log_thread;
+    pof_log_thread = NULL;
+    furi_thread_flags_set(furi_thread_get_id(thread), PoFLogEventExit);
+    furi_thread_join(thread);
+    furi_thread_free(thread);
+}
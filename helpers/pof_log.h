@@ -0,0 +1,18 @@
+#pragma once
+
+#include <furi.h>
+
+#define POF_LOG_DATA_SIZE 16
+
+/*
+ * Protocol logging that stays off the USB worker: the worker only copies the raw
+ * arguments into a ring, a low priority thread formats and prints them later.
+ * Entries are dropped straight away when the log level would hide them anyway.
+ */
+
+// Starts the formatter, entries are dropped until then
+void pof_log_start(void);
+void pof_log_stop(void);
+
+// Only call from the USB worker, the ring has a single producer. data may be NULL.
+void pof_log_command(char command, uint8_t slot, uint8_t block, const uint8_t* data);
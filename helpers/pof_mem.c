@@ -0,0 +1,185 @@
+#include "pof_mem.h"
+
+#define TAG "PoFMem"
+
+typedef struct {
+    size_t current;
+    size_t peak;
+} PoFMemHeap;
+
+typedef struct {
+    FuriThreadId id; // NULL while the thread isn't running
+    uint32_t stack_size;
+    uint32_t min_free; // 0 until sampled once
+    bool warned;
+} PoFMemStack;
+
+static PoFMemHeap pof_mem_heap[PoFMemSubsystemCount];
+// The stacks and the warned flags are guarded by the mutex
+static FuriMutex* pof_mem_mutex = NULL;
+static PoFMemStack pof_mem_stack[PoFMemThreadCount];
+static bool pof_mem_heap_warned = false;
+
+static const char* const pof_mem_subsystem_names[PoFMemSubsystemCount] = {
+    [PoFMemTokens] = "tokens",
+    [PoFMemPortal] = "portal",
+    [PoFMemAudio] = "audio",
+    [PoFMemUsb] = "usb",
+    [PoFMemUi] = "ui",
+};
+
+static const char* const pof_mem_thread_names[PoFMemThreadCount] = {
+    [PoFMemThreadApp] = "app",
+    [PoFMemThreadUsb] = "usb",
+    [PoFMemThreadLog] = "log",
+    [PoFMemThreadTrace] = "trace",
+    [PoFMemThreadSession] = "session",
+};
+
+static void pof_mem_heap_set(PoFMemSubsystem subsystem, size_t current) {
+    PoFMemHeap* heap = &pof_mem_heap[subsystem];
+    heap->current = current;
+    if (current > heap->peak) {
+        heap->peak = current;
+    }
+}
+
+void pof_mem_heap_end(PoFMemSubsystem subsystem, size_t start) {
+    size_t free = memmgr_get_free_heap();
+    size_t used = start > free ? start - free : 0;
+    pof_mem_heap_set(subsystem, pof_mem_heap[subsystem].current + used);
+}
+
+void pof_mem_heap_move(PoFMemSubsystem from, PoFMemSubsystem to, size_t size) {
+    PoFMemHeap* heap = &pof_mem_heap[from];
+    heap->current = heap->current > size ? heap->current - size : 0;
+    heap->peak = heap->peak > size ? heap->peak - size : 0;
+    pof_mem_heap_set(to, pof_mem_heap[to].current + size);
+}
+
+void pof_mem_heap_release(PoFMemSubsystem subsystem) {
+    pof_mem_heap[subsystem].current = 0;
+}
+
+void pof_mem_init(void) {
+    furi_assert(!pof_mem_mutex);
+    pof_mem_mutex = furi_mutex_alloc(FuriMutexTypeNormal);
+}
+
+void pof_mem_deinit(void) {
+    furi_assert(pof_mem_mutex);
+    furi_mutex_free(pof_mem_mutex);
+    pof_mem_mutex = NULL;
+}
+
+/*
+ * Caller holds the mutex, so the thread can't get past pof_mem_thread_exit and end
+ * while its stack is scanned. The scan is slow, interrupts stay enabled for it.
+ */
+static void pof_mem_stack_update(PoFMemStack* stack) {
+    uint32_t free = furi_thread_get_stack_space(stack->id);
+    if (stack->min_free == 0 || free < stack->min_free) {
+        stack->min_free = free;
+    }
+}
+
+void pof_mem_thread_enter(PoFMemThread thread, uint32_t stack_size) {
+    furi_mutex_acquire(pof_mem_mutex, FuriWaitForever);
+    pof_mem_stack[thread].id = furi_thread_get_current_id();
+    pof_mem_stack[thread].stack_size = stack_size;
+    furi_mutex_release(pof_mem_mutex);
+}
+
+void pof_mem_thread_exit(PoFMemThread thread) {
+    furi_mutex_acquire(pof_mem_mutex, FuriWaitForever);
+    PoFMemStack* stack = &pof_mem_stack[thread];
+    if (stack->id) {
+        pof_mem_stack_update(stack);
+        stack->id = NULL;
+    }
+    furi_mutex_release(pof_mem_mutex);
+    pof_mem_sample();
+}
+
+void pof_mem_sample(void) {
+    // Logged after the mutex is released
+    uint32_t warn_min_free[PoFMemThreadCount] = {0};
+    size_t heap_min_free = memmgr_get_minimum_free_heap();
+    bool heap_warn = false;
+
+    furi_mutex_acquire(pof_mem_mutex, FuriWaitForever);
+    for (size_t i = 0; i < PoFMemThreadCount; i++) {
+        PoFMemStack* stack = &pof_mem_stack[i];
+        if (stack->id) {
+            pof_mem_stack_update(stack);
+        }
+        if (stack->min_free && stack->min_free < POF_MEM_STACK_WARN && !stack->warned) {
+            stack->warned = true;
+            warn_min_free[i] = stack->min_free;
+        }
+    }
+    if (heap_min_free < POF_MEM_HEAP_WARN && !pof_mem_heap_warned) {
+        pof_mem_heap_warned = true;
+        heap_warn = true;
+    }
+    furi_mutex_release(pof_mem_mutex);
+
+    for (size_t i = 0; i < PoFMemThreadCount; i++) {
+        if (warn_min_free[i]) {
+            FURI_LOG_W(
+                TAG,
+                "%s thread down to %lu of %lu stack bytes",
+                pof_mem_thread_names[i],
+                warn_min_free[i],
+                pof_mem_stack[i].stack_size);
+        }
+    }
+    if (heap_warn) {
+        FURI_LOG_W(TAG, "Free heap went down to %u bytes", heap_min_free);
+    }
+}
+
+void pof_mem_format(FuriString* out) {
+    furi_string_cat_printf(
+        out,
+        "heap free %u min %u\n",
+        memmgr_get_free_heap(),
+        memmgr_get_minimum_free_heap());
+    for (size_t i = 0; i < PoFMemSubsystemCount; i++) {
+        furi_string_cat_printf(
+            out,
+            "%s %u peak %u\n",
+            pof_mem_subsystem_names[i],
+            pof_mem_heap[i].current,
+            pof_mem_heap[i].peak);
+    }
+    furi_mutex_acquire(pof_mem_mutex, FuriWaitForever);
+    for (size_t i = 0; i < PoFMemThreadCount; i++) {
+        PoFMemStack* stack = &pof_mem_stack[i];
+        if (stack->min_free == 0) {
+            continue;
+        }
+        furi_string_cat_printf(
+            out,
+            "%s%s stack %lu/%lu\n",
+            stack->min_free < POF_MEM_STACK_WARN ? "!" : "",
+            pof_mem_thread_names[i],
+            stack->stack_size - stack->min_free,
+            stack->stack_size);
+    }
+    furi_mutex_release(pof_mem_mutex);
+}
+
+void pof_mem_log(void) {
+    pof_mem_sample();
+    FuriString* text = furi_string_alloc();
+    pof_mem_format(text);
+    // One line each, the log doesn't like embedded newlines
+    size_t start = 0;
+    size_t end;
+    while ((end = furi_string_search_char(text, '\n', start)) != FURI_STRING_FAILURE) {
+        FURI_LOG_I(TAG, "%.*s", (int)(end - start), furi_string_get_cstr(text) + start);
+        start = end + 1;
+    }
+    furi_string_free(text);
+}
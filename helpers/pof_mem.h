@@ -0,0 +1,57 @@
+#pragma once
+
+#include <furi.h>
+
+// Warn when a thread gets this close to the end of its stack
+#define POF_MEM_STACK_WARN 256
+// Warn when the lowest free heap since boot drops below this
+#define POF_MEM_HEAP_WARN (8 * 1024)
+// How often the USB worker samples while the portal is active
+#define POF_MEM_SAMPLE_INTERVAL 1000
+
+typedef enum {
+    PoFMemTokens,
+    PoFMemPortal,
+    PoFMemAudio,
+    PoFMemUsb,
+    PoFMemUi,
+
+    PoFMemSubsystemCount,
+} PoFMemSubsystem;
+
+typedef enum {
+    PoFMemThreadApp,
+    PoFMemThreadUsb,
+    PoFMemThreadLog,
+    PoFMemThreadTrace,
+    PoFMemThreadSession,
+
+    PoFMemThreadCount,
+} PoFMemThread;
+
+/*
+ * Heap use is the drop in free heap around an allocation, so other threads
+ * allocating at the same time make it approximate.
+ */
+static inline size_t pof_mem_heap_begin(void) {
+    return memmgr_get_free_heap();
+}
+void pof_mem_heap_end(PoFMemSubsystem subsystem, size_t start);
+// For memory inside another allocation, like the audio buffers in VirtualPortal
+void pof_mem_heap_move(PoFMemSubsystem from, PoFMemSubsystem to, size_t size);
+// Subsystem was freed, its peak is kept
+void pof_mem_heap_release(PoFMemSubsystem subsystem);
+
+// Before the first thread enters and after the last one exits
+void pof_mem_init(void);
+void pof_mem_deinit(void);
+
+// Called by the thread itself, so it is never sampled after it is gone
+void pof_mem_thread_enter(PoFMemThread thread, uint32_t stack_size);
+void pof_mem_thread_exit(PoFMemThread thread);
+
+// Updates the stack high-water marks of running threads and warns about thresholds.
+// Scans each stack, so keep it off hot paths.
+void pof_mem_sample(void);
+void pof_mem_format(FuriString* out);
+void pof_mem_log(void);
@@ -0,0 +1,251 @@
+#include "pof_probe.h"
+
+#include <storage/storage.h>
+
+#define TAG "PoFProbe"
+
+static PoFProbe pof_probes[PoFProbeCount];
+// Only saved after a load, otherwise the file would lose its history to empty stats
+static bool pof_probe_latency_loaded = false;
+
+static const char* const pof_probe_names[PoFProbeCount] = {
+    [PoFProbeMessageA] = "A",
+    [PoFProbeMessageC] = "C",
+    [PoFProbeMessageJ] = "J",
+    [PoFProbeMessageL] = "L",
+    [PoFProbeMessageM] = "M",
+    [PoFProbeMessageQ] = "Q",
+    [PoFProbeMessageR] = "R",
+    [PoFProbeMessageS] = "S",
+    [PoFProbeMessageV] = "V",
+    [PoFProbeMessageW] = "W",
+    [PoFProbeMessageOther] = "?",
+    [PoFProbeAudio] = "audio",
+    [PoFProbeAudio360] = "audio360",
+    [PoFProbeDmaIsr] = "dma isr",
+    [PoFProbeXsm3Init] = "xsm3 init",
+    [PoFProbeXsm3Verify] = "xsm3 verify",
+    [PoFProbeNfcSave] = "nfc save",
+    [PoFProbeFigureVerify] = "verify",
+    [PoFProbeLatencyA] = "A lat",
+    [PoFProbeLatencyR] = "R lat",
+    [PoFProbeLatencyS] = "S lat",
+    [PoFProbeLatencyQ] = "Q lat",
+    [PoFProbeLatencyW] = "W lat",
+    [PoFProbeLatencyM] = "M lat",
+    [PoFProbeLatencyJ] = "J lat",
+    [PoFProbeDoneC] = "C done",
+    [PoFProbeDoneL] = "L done",
+    [PoFProbeDoneV] = "V done",
+    [PoFProbeStatusInterval] = "S gap",
+};
+
+#define POF_PROBE_LATENCY_FIRST PoFProbeLatencyA
+#define POF_PROBE_LATENCY_COUNT (PoFProbeCount - PoFProbeLatencyA)
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t count;
+    uint32_t size;
+} PoFProbeLatencyHeader;
+
+void pof_probe_end(PoFProbeId id, uint32_t start) {
+    uint32_t cycles = DWT->CYCCNT - start;
+    PoFProbe* probe = &pof_probes[id];
+    if (probe->count == 0 || cycles < probe->min) {
+        probe->min = cycles;
+    }
+    if (cycles > probe->max) {
+        probe->max = cycles;
+    }
+    probe->total += cycles;
+    probe->histogram[31 - __builtin_clz(cycles | 1)]++;
+    probe->count++;
+}
+
+PoFProbeId pof_probe_message_id(uint8_t command) {
+    switch (command) {
+        case 'A':
+            return PoFProbeMessageA;
+        case 'C':
+            return PoFProbeMessageC;
+        case 'J':
+            return PoFProbeMessageJ;
+        case 'L':
+            return PoFProbeMessageL;
+        case 'M':
+            return PoFProbeMessageM;
+        case 'Q':
+            return PoFProbeMessageQ;
+        case 'R':
+            return PoFProbeMessageR;
+        case 'S':
+            return PoFProbeMessageS;
+        case 'V':
+            return PoFProbeMessageV;
+        case 'W':
+            return PoFProbeMessageW;
+        default:
+            return PoFProbeMessageOther;
+    }
+}
+
+PoFProbeId pof_probe_latency_id(uint8_t command) {
+    switch (command) {
+        case 'A':
+            return PoFProbeLatencyA;
+        case 'R':
+            return PoFProbeLatencyR;
+        case 'S':
+            return PoFProbeLatencyS;
+        case 'Q':
+            return PoFProbeLatencyQ;
+        case 'W':
+            return PoFProbeLatencyW;
+        case 'M':
+            return PoFProbeLatencyM;
+        case 'J':
+            return PoFProbeLatencyJ;
+        default:
+            return PoFProbeCount;
+    }
+}
+
+PoFProbeId pof_probe_done_id(uint8_t command) {
+    switch (command) {
+        case 'C':
+            return PoFProbeDoneC;
+        case 'L':
+            return PoFProbeDoneL;
+        case 'V':
+            return PoFProbeDoneV;
+        default:
+            return PoFProbeCount;
+    }
+}
+
+const PoFProbe* pof_probe_get(PoFProbeId id) {
+    furi_assert(id < PoFProbeCount);
+    return &pof_probes[id];
+}
+
+const char* pof_probe_name(PoFProbeId id) {
+    furi_assert(id < PoFProbeCount);
+    return pof_probe_names[id];
+}
+
+void pof_probe_reset(void) {
+    FURI_CRITICAL_ENTER();
+    memset(pof_probes, 0, sizeof(pof_probes));
+    FURI_CRITICAL_EXIT();
+}
+
+void pof_probe_format(FuriString* out) {
+    uint32_t cycles_per_us = furi_hal_cortex_instructions_per_microsecond();
+    for (size_t i = 0; i < PoFProbeCount; i++) {
+        PoFProbe probe = pof_probes[i];
+        if (probe.count == 0) {
+            continue;
+        }
+        furi_string_cat_printf(
+            out,
+            "%s n%lu %lu/%lu/%lu\n",
+            pof_probe_names[i],
+            probe.count,
+            probe.min / cycles_per_us,
+            (uint32_t)(probe.total / probe.count) / cycles_per_us,
+            probe.max / cycles_per_us);
+    }
+}
+
+bool pof_probe_save(const char* path) {
+    FuriString* line = furi_string_alloc();
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    File* file = storage_file_alloc(storage);
+    bool ok = storage_file_open(file, path, FSAM_WRITE, FSOM_CREATE_ALWAYS);
+    if (ok) {
+        furi_string_printf(
+            line,
+            "# cycles at %lu MHz: name count min mean max, then log2 histogram\n",
+            furi_hal_cortex_instructions_per_microsecond());
+        ok = storage_file_write(file, furi_string_get_cstr(line), furi_string_size(line)) ==
+             furi_string_size(line);
+    }
+    for (size_t i = 0; ok && i < PoFProbeCount; i++) {
+        PoFProbe probe = pof_probes[i];
+        furi_string_printf(
+            line,
+            "%s %lu %lu %lu %lu",
+            pof_probe_names[i],
+            probe.count,
+            probe.min,
+            probe.count ? (uint32_t)(probe.total / probe.count) : 0,
+            probe.max);
+        for (size_t bucket = 0; bucket < POF_PROBE_BUCKETS; bucket++) {
+            furi_string_cat_printf(line, " %lu", probe.histogram[bucket]);
+        }
+        furi_string_push_back(line, '\n');
+        ok = storage_file_write(file, furi_string_get_cstr(line), furi_string_size(line)) ==
+             furi_string_size(line);
+    }
+    if (!ok) {
+        FURI_LOG_E(TAG, "Failed to save probes to %s", path);
+    }
+    storage_file_close(file);
+    storage_file_free(file);
+    furi_record_close(RECORD_STORAGE);
+    furi_string_free(line);
+    return ok;
+}
+
+void pof_probe_latency_load(void) {
+    pof_probe_latency_loaded = true;
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    File* file = storage_file_alloc(storage);
+    if (storage_file_open(file, POF_PROBE_LATENCY_PATH, FSAM_READ, FSOM_OPEN_EXISTING)) {
+        PoFProbeLatencyHeader header;
+        PoFProbe* probes = &pof_probes[POF_PROBE_LATENCY_FIRST];
+        size_t size = POF_PROBE_LATENCY_COUNT * sizeof(PoFProbe);
+        bool ok = storage_file_read(file, &header, sizeof(header)) == sizeof(header) &&
+                  header.magic == POF_PROBE_LATENCY_MAGIC &&
+                  header.version == POF_PROBE_LATENCY_VERSION &&
+                  header.count == POF_PROBE_LATENCY_COUNT && header.size == sizeof(PoFProbe) &&
+                  storage_file_read(file, probes, size) == size;
+        if (!ok) {
+            FURI_LOG_W(TAG, "Ignoring bad latency stats");
+            memset(probes, 0, size);
+        }
+    }
+    storage_file_close(file);
+    storage_file_free(file);
+    furi_record_close(RECORD_STORAGE);
+}
+
+bool pof_probe_latency_save(void) {
+    if (!pof_probe_latency_loaded) {
+        return true;
+    }
+    pof_probe_latency_loaded = false;
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    File* file = storage_file_alloc(storage);
+    bool ok = storage_file_open(file, POF_PROBE_LATENCY_PATH, FSAM_WRITE, FSOM_CREATE_ALWAYS);
+    if (ok) {
+        PoFProbeLatencyHeader header = {
+            .magic = POF_PROBE_LATENCY_MAGIC,
+            .version = POF_PROBE_LATENCY_VERSION,
+            .count = POF_PROBE_LATENCY_COUNT,
+            .size = sizeof(PoFProbe),
+        };
+        size_t size = POF_PROBE_LATENCY_COUNT * sizeof(PoFProbe);
+        ok = storage_file_write(file, &header, sizeof(header)) == sizeof(header) &&
+             storage_file_write(file, &pof_probes[POF_PROBE_LATENCY_FIRST], size) == size;
+    }
+    if (!ok) {
+        FURI_LOG_E(TAG, "Failed to save latency stats");
+    }
+    storage_file_close(file);
+    storage_file_free(file);
+    furi_record_close(RECORD_STORAGE);
+    return ok;
+}
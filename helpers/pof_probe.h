@@ -0,0 +1,85 @@
+#pragma once
+
+#include <furi.h>
+#include <furi_hal_cortex.h>
+
+// Histogram bucket n counts samples of 2^n .. 2^(n+1)-1 cycles
+#define POF_PROBE_BUCKETS 32
+
+#define POF_PROBE_PATH APP_DATA_PATH("probes.txt")
+// Latency probes are kept across sessions
+#define POF_PROBE_LATENCY_PATH APP_DATA_PATH("latency.bin")
+#define POF_PROBE_LATENCY_MAGIC 0x4C464F50 // "POFL"
+#define POF_PROBE_LATENCY_VERSION 1
+
+typedef enum {
+    PoFProbeMessageA,
+    PoFProbeMessageC,
+    PoFProbeMessageJ,
+    PoFProbeMessageL,
+    PoFProbeMessageM,
+    PoFProbeMessageQ,
+    PoFProbeMessageR,
+    PoFProbeMessageS,
+    PoFProbeMessageV,
+    PoFProbeMessageW,
+    PoFProbeMessageOther,
+    PoFProbeAudio,
+    PoFProbeAudio360,
+    PoFProbeDmaIsr,
+    PoFProbeXsm3Init,
+    PoFProbeXsm3Verify,
+    PoFProbeNfcSave,
+    // One checksum region of a figure
+    PoFProbeFigureVerify,
+
+    // From a command coming in to its response going to the IN endpoint
+    PoFProbeLatencyA,
+    PoFProbeLatencyR,
+    PoFProbeLatencyS,
+    PoFProbeLatencyQ,
+    PoFProbeLatencyW,
+    PoFProbeLatencyM,
+    PoFProbeLatencyJ,
+    // From a command coming in to it being processed, these never get a response
+    PoFProbeDoneC,
+    PoFProbeDoneL,
+    PoFProbeDoneV,
+    // Between two status frames going to the IN endpoint
+    PoFProbeStatusInterval,
+
+    PoFProbeCount,
+} PoFProbeId;
+
+// Not locked: readers may see a torn sample, and two writers racing can lose one
+typedef struct {
+    uint32_t count;
+    uint32_t min;
+    uint32_t max;
+    uint64_t total;
+    uint32_t histogram[POF_PROBE_BUCKETS];
+} PoFProbe;
+
+static inline uint32_t pof_probe_start(void) {
+    return DWT->CYCCNT;
+}
+
+void pof_probe_end(PoFProbeId id, uint32_t start);
+
+PoFProbeId pof_probe_message_id(uint8_t command);
+// PoFProbeCount for commands without a latency probe
+PoFProbeId pof_probe_latency_id(uint8_t command);
+// PoFProbeCount for commands that can get a response
+PoFProbeId pof_probe_done_id(uint8_t command);
+
+const PoFProbe* pof_probe_get(PoFProbeId id);
+const char* pof_probe_name(PoFProbeId id);
+void pof_probe_reset(void);
+
+// One line per probe that has samples, times in us
+void pof_probe_format(FuriString* out);
+bool pof_probe_save(const char* path);
+
+// Latency probes only, in binary. Saving does nothing unless loaded since the last save.
+void pof_probe_latency_load(void);
+bool pof_probe_latency_save(void);
@@ -0,0 +1,215 @@
+#include "pof_session.h"
+
+#include <storage/storage.h>
+
+#include "pof_mem.h"
+
+#define TAG "PoFSession"
+
+#define POF_SESSION_STACK_SIZE 4096
+
+static FuriThread* pof_session_thread = NULL;
+static bool pof_session_stopping = false;
+// False while slots are left to restore, saving then would forget them
+static bool pof_session_complete = true;
+
+static bool pof_session_stat(Storage* storage, PoFSessionSlot* slot) {
+    FileInfo info;
+    uint32_t timestamp = 0;
+    if (storage_common_stat(storage, slot->path, &info) != FSE_OK ||
+        storage_common_timestamp(storage, slot->path, &timestamp) != FSE_OK) {
+        return false;
+    }
+    slot->file_size = info.size;
+    slot->file_timestamp = timestamp;
+    return true;
+}
+
+static void pof_session_snapshot_save(PoFSessionSnapshot* snapshot, const MfClassicData* data) {
+    const Iso14443_3aData* iso = data->iso14443_3a_data;
+    memset(snapshot, 0, sizeof(PoFSessionSnapshot));
+    memcpy(snapshot->uid, iso->uid, sizeof(snapshot->uid));
+    snapshot->uid_len = iso->uid_len;
+    memcpy(snapshot->atqa, iso->atqa, sizeof(snapshot->atqa));
+    snapshot->sak = iso->sak;
+    memcpy(snapshot->block_read_mask, data->block_read_mask, sizeof(snapshot->block_read_mask));
+    snapshot->key_a_mask = data->key_a_mask;
+    snapshot->key_b_mask = data->key_b_mask;
+    for (size_t i = 0; i < POF_SESSION_BLOCKS; i++) {
+        memcpy(snapshot->blocks[i], data->block[i].data, sizeof(snapshot->blocks[i]));
+    }
+}
+
+static void pof_session_snapshot_load(MfClassicData* data, const PoFSessionSnapshot* snapshot) {
+    Iso14443_3aData* iso = data->iso14443_3a_data;
+    data->type = MfClassicType1k;
+    memcpy(iso->uid, snapshot->uid, sizeof(snapshot->uid));
+    iso->uid_len = MIN(snapshot->uid_len, sizeof(snapshot->uid));
+    memcpy(iso->atqa, snapshot->atqa, sizeof(snapshot->atqa));
+    iso->sak = snapshot->sak;
+    memcpy(data->block_read_mask, snapshot->block_read_mask, sizeof(snapshot->block_read_mask));
+    data->key_a_mask = snapshot->key_a_mask;
+    data->key_b_mask = snapshot->key_b_mask;
+    for (size_t i = 0; i < POF_SESSION_BLOCKS; i++) {
+        memcpy(data->block[i].data, snapshot->blocks[i], sizeof(snapshot->blocks[i]));
+    }
+}
+
+bool pof_session_save(VirtualPortal* virtual_portal) {
+    furi_assert(virtual_portal);
+
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    File* file = storage_file_alloc(storage);
+    PoFSessionSnapshot* snapshot = malloc(sizeof(PoFSessionSnapshot));
+    bool ok = storage_file_open(file, POF_SESSION_PATH, FSAM_WRITE, FSOM_CREATE_ALWAYS);
+    if (ok) {
+        PoFSessionHeader header = {
+            .magic = POF_SESSION_MAGIC,
+            .version = POF_SESSION_VERSION,
+            .count = POF_TOKEN_LIMIT,
+            .slot_size = sizeof(PoFSessionSlot),
+            .snapshot_size = sizeof(PoFSessionSnapshot),
+        };
+        ok = storage_file_write(file, &header, sizeof(header)) == sizeof(header);
+    }
+    for (size_t i = 0; ok && i < POF_TOKEN_LIMIT; i++) {
+        PoFToken* pof_token = virtual_portal->tokens[i];
+        PoFSessionSlot slot;
+        memset(&slot, 0, sizeof(slot));
+        memcpy(slot.uid, pof_token->UID, sizeof(slot.uid));
+        if (pof_token->loaded &&
+            furi_string_size(pof_token->load_path) < sizeof(slot.path)) {
+            slot.loaded = true;
+            strlcpy(slot.path, furi_string_get_cstr(pof_token->load_path), sizeof(slot.path));
+            const MfClassicData* data = pof_image_get_data(pof_token->image);
+            // Writes were saved to the file already, so the snapshot matches it as it is now
+            if (data->type == MfClassicType1k && pof_session_stat(storage, &slot)) {
+                slot.snapshot = true;
+                pof_session_snapshot_save(snapshot, data);
+            }
+        }
+        ok = storage_file_write(file, &slot, sizeof(slot)) == sizeof(slot);
+        if (ok && slot.snapshot) {
+            ok = storage_file_write(file, snapshot, sizeof(PoFSessionSnapshot)) ==
+                 sizeof(PoFSessionSnapshot);
+        }
+    }
+    if (!ok) {
+        FURI_LOG_E(TAG, "Failed to save session");
+    }
+    free(snapshot);
+    storage_file_close(file);
+    storage_file_free(file);
+    furi_record_close(RECORD_STORAGE);
+    return ok;
+}
+
+static bool pof_session_restore_slot(
+    Storage* storage,
+    PoFToken* scratch,
+    MfClassicData* data,
+    PoFSessionSlot* slot,
+    const PoFSessionSnapshot* snapshot) {
+    uint32_t file_size = slot->file_size;
+    uint32_t file_timestamp = slot->file_timestamp;
+    if (slot->snapshot && pof_session_stat(storage, slot) && slot->file_size == file_size &&
+        slot->file_timestamp == file_timestamp) {
+        pof_session_snapshot_load(data, snapshot);
+        pof_token_set_data(scratch, slot->path, data);
+        return true;
+    }
+    // Changed since the session was saved, or never had a snapshot
+    slot->snapshot = false;
+    return pof_token_load_path(scratch, slot->path);
+}
+
+static int32_t pof_session_worker(void* context) {
+    VirtualPortal* virtual_portal = context;
+    pof_mem_thread_enter(PoFMemThreadSession, POF_SESSION_STACK_SIZE);
+    uint32_t start = furi_get_tick();
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    File* file = storage_file_alloc(storage);
+    PoFSessionSnapshot* snapshot = malloc(sizeof(PoFSessionSnapshot));
+    PoFToken* scratch = pof_token_alloc();
+    MfClassicData* data = mf_classic_alloc();
+    size_t restored = 0;
+    size_t from_snapshot = 0;
+    bool complete = true;
+
+    if (storage_file_open(file, POF_SESSION_PATH, FSAM_READ, FSOM_OPEN_EXISTING)) {
+        PoFSessionHeader header;
+        bool ok = storage_file_read(file, &header, sizeof(header)) == sizeof(header) &&
+                  header.magic == POF_SESSION_MAGIC && header.version == POF_SESSION_VERSION &&
+                  header.count == POF_TOKEN_LIMIT && header.slot_size == sizeof(PoFSessionSlot) &&
+                  header.snapshot_size == sizeof(PoFSessionSnapshot);
+        if (!ok) {
+            FURI_LOG_W(TAG, "Ignoring bad session");
+        }
+        for (uint8_t i = 0; ok && i < POF_TOKEN_LIMIT; i++) {
+            if (__atomic_load_n(&pof_session_stopping, __ATOMIC_ACQUIRE)) {
+                complete = false;
+                break;
+            }
+            PoFSessionSlot slot;
+            ok = storage_file_read(file, &slot, sizeof(slot)) == sizeof(slot);
+            if (ok && slot.snapshot) {
+                ok = storage_file_read(file, snapshot, sizeof(PoFSessionSnapshot)) ==
+                     sizeof(PoFSessionSnapshot);
+            }
+            if (!ok) {
+                FURI_LOG_W(TAG, "Session ended early");
+                break;
+            }
+            slot.path[sizeof(slot.path) - 1] = '\0';
+            if (!slot.loaded) {
+                virtual_portal_restore_token(virtual_portal, i, slot.uid, NULL);
+                continue;
+            }
+            pof_token_clear(scratch, false);
+            if (pof_session_restore_slot(storage, scratch, data, &slot, snapshot) &&
+                virtual_portal_restore_token(virtual_portal, i, slot.uid, scratch)) {
+                restored++;
+                from_snapshot += slot.snapshot;
+            }
+        }
+    }
+
+    FURI_LOG_I(
+        TAG,
+        "Restored %u figures in %lu ms (%u from snapshot)",
+        restored,
+        furi_get_tick() - start,
+        from_snapshot);
+    mf_classic_free(data);
+    pof_token_free(scratch);
+    free(snapshot);
+    storage_file_close(file);
+    storage_file_free(file);
+    furi_record_close(RECORD_STORAGE);
+    pof_session_complete = complete;
+    pof_mem_thread_exit(PoFMemThreadSession);
+    return 0;
+}
+
+void pof_session_restore_start(VirtualPortal* virtual_portal) {
+    if (pof_session_thread) {
+        return;
+    }
+    __atomic_store_n(&pof_session_stopping, false, __ATOMIC_RELEASE);
+    pof_session_complete = false;
+    pof_session_thread = furi_thread_alloc_ex(
+        "PoFSession", POF_SESSION_STACK_SIZE, pof_session_worker, virtual_portal);
+    // Below the USB worker, enumeration and the first queries come first
+    furi_thread_set_priority(pof_session_thread, FuriThreadPriorityLow);
+    furi_thread_start(pof_session_thread);
+}
+
+bool pof_session_restore_stop(void) {
+    if (pof_session_thread) {
+        __atomic_store_n(&pof_session_stopping, true, __ATOMIC_RELEASE);
+        furi_thread_join(pof_session_thread);
+        furi_thread_free(pof_session_thread);
+        pof_session_thread = NULL;
+    }
+    return pof_session_complete;
+}
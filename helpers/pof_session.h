@@ -0,0 +1,54 @@
+#pragma once
+
+#include <furi.h>
+
+#include "../virtual_portal.h"
+
+#define POF_SESSION_PATH APP_DATA_PATH("session.bin")
+#define POF_SESSION_MAGIC 0x53464F50 // "POFS"
+#define POF_SESSION_VERSION 1
+#define POF_SESSION_PATH_LEN 128
+#define POF_SESSION_BLOCKS 64
+
+/*
+ * File layout: a PoFSessionHeader, then a PoFSessionSlot for every slot, each followed by
+ * a PoFSessionSnapshot when its snapshot flag is set. The snapshot is the figure as it was
+ * at exit, it is used instead of parsing the .nfc file again while the file is unchanged.
+ */
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t count;
+    uint32_t slot_size;
+    uint32_t snapshot_size;
+} PoFSessionHeader;
+
+typedef struct {
+    uint8_t uid[4]; // slot affinity, kept after the figure is removed
+    uint8_t loaded;
+    uint8_t snapshot;
+    uint16_t reserved;
+    uint32_t file_size;
+    uint32_t file_timestamp;
+    char path[POF_SESSION_PATH_LEN];
+} PoFSessionSlot;
+
+typedef struct {
+    uint8_t uid[10];
+    uint8_t uid_len;
+    uint8_t atqa[2];
+    uint8_t sak;
+    uint8_t reserved[2];
+    uint32_t block_read_mask[POF_SESSION_BLOCKS / 32];
+    uint64_t key_a_mask;
+    uint64_t key_b_mask;
+    uint8_t blocks[POF_SESSION_BLOCKS][16];
+} PoFSessionSnapshot;
+
+// Call once the USB worker is stopped, so no figure is written while it is saved
+bool pof_session_save(VirtualPortal* virtual_portal);
+
+// Puts the figures back on the portal from a background thread
+void pof_session_restore_start(VirtualPortal* virtual_portal);
+// Abandons a restore that is still running, false if it didn't get to every slot
+bool pof_session_restore_stop(void);
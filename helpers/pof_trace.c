@@ -0,0 +1,241 @@
+#include "pof_trace.h"
+
+#include <furi_hal_cortex.h>
+#include <storage/storage.h>
+
+#include "pof_mem.h"
+
+#define TAG "PoFTrace"
+
+#define POF_TRACE_STACK_SIZE (2 * 1024)
+
+// Power of two, so the running index can wrap
+#define POF_TRACE_RING_SIZE 64
+// The writer wakes this often, well before the ring fills at full USB traffic
+#define POF_TRACE_FLUSH_INTERVAL 50
+#define POF_TRACE_BATCH 16
+
+typedef enum {
+    PoFTraceEventExit = (1 << 0),
+} PoFTraceEvent;
+
+typedef struct {
+    // index + 1 of the record in the slot, 0 while it is being written
+    uint32_t seq;
+    PoFTraceRecord record;
+} PoFTraceSlot;
+
+static PoFTraceSlot pof_trace_ring[POF_TRACE_RING_SIZE];
+// Next index to claim, only ever incremented
+static uint32_t pof_trace_head = 0;
+// Only while the writer has the file open
+static bool pof_trace_enabled = false;
+static bool pof_trace_failed = false;
+static FuriThread* pof_trace_thread = NULL;
+
+void pof_trace_record(PoFTraceType type, uint8_t endpoint, const uint8_t* data, uint16_t length) {
+    if (!__atomic_load_n(&pof_trace_enabled, __ATOMIC_RELAXED)) {
+        return;
+    }
+    uint32_t index = __atomic_fetch_add(&pof_trace_head, 1, __ATOMIC_RELAXED);
+    PoFTraceSlot* slot = &pof_trace_ring[index % POF_TRACE_RING_SIZE];
+    __atomic_store_n(&slot->seq, 0, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    slot->record.tick = furi_get_tick();
+    slot->record.cycles = DWT->CYCCNT;
+    slot->record.type = type;
+    slot->record.endpoint = endpoint;
+    slot->record.length = length;
+    uint16_t copy = MIN(length, POF_TRACE_DATA_SIZE);
+    memcpy(slot->record.data, data, copy);
+    memset(slot->record.data + copy, 0, POF_TRACE_DATA_SIZE - copy);
+
+    __atomic_store_n(&slot->seq, index + 1, __ATOMIC_RELEASE);
+}
+
+typedef enum {
+    PoFTraceTakeEmpty, // nothing finished yet
+    PoFTraceTakeRecord,
+    PoFTraceTakeLost, // skipped over records that were overwritten, lost was increased
+} PoFTraceTake;
+
+static PoFTraceTake pof_trace_take(uint32_t* tail, uint32_t* lost, PoFTraceRecord* out) {
+    uint32_t head = __atomic_load_n(&pof_trace_head, __ATOMIC_ACQUIRE);
+    if (head - *tail > POF_TRACE_RING_SIZE) {
+        // Lapped, the oldest ones are gone
+        *lost += head - *tail - POF_TRACE_RING_SIZE;
+        *tail = head - POF_TRACE_RING_SIZE;
+        return PoFTraceTakeLost;
+    }
+    if (*tail == head) {
+        return PoFTraceTakeEmpty;
+    }
+    PoFTraceSlot* slot = &pof_trace_ring[*tail % POF_TRACE_RING_SIZE];
+    uint32_t seq = __atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE);
+    int32_t ahead = (int32_t)(seq - (*tail + 1));
+    if (seq == 0 || ahead < 0) {
+        // Claimed but not written yet
+        return PoFTraceTakeEmpty;
+    }
+    if (ahead == 0) {
+        *out = slot->record;
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&slot->seq, __ATOMIC_RELAXED) == seq) {
+            (*tail)++;
+            return PoFTraceTakeRecord;
+        }
+    }
+    // Overwritten by a newer record
+    (*lost)++;
+    (*tail)++;
+    return PoFTraceTakeLost;
+}
+
+typedef struct {
+    File* file;
+    bool ok;
+    uint32_t written;
+    size_t count;
+    PoFTraceRecord batch[POF_TRACE_BATCH];
+} PoFTraceWriter;
+
+static void pof_trace_flush(PoFTraceWriter* writer) {
+    if (writer->ok && writer->count) {
+        size_t size = writer->count * sizeof(PoFTraceRecord);
+        writer->ok = storage_file_write(writer->file, writer->batch, size) == size;
+        if (!writer->ok) {
+            FURI_LOG_E(TAG, "Failed to write %s", POF_TRACE_PATH);
+        }
+        writer->written += writer->count;
+    }
+    writer->count = 0;
+}
+
+static PoFTraceRecord* pof_trace_next(PoFTraceWriter* writer) {
+    if (writer->count == POF_TRACE_BATCH) {
+        pof_trace_flush(writer);
+    }
+    return &writer->batch[writer->count++];
+}
+
+static void pof_trace_add_dropped(PoFTraceWriter* writer, uint32_t* lost) {
+    while (*lost) {
+        PoFTraceRecord* marker = pof_trace_next(writer);
+        memset(marker, 0, sizeof(PoFTraceRecord));
+        marker->tick = furi_get_tick();
+        marker->cycles = DWT->CYCCNT;
+        marker->type = PoFTraceDropped;
+        marker->length = MIN(*lost, UINT16_MAX);
+        *lost -= marker->length;
+    }
+}
+
+static int32_t pof_trace_worker(void* context) {
+    // Released once the file is open or failed to, pof_trace_start frees it after that
+    FuriSemaphore* opened = context;
+    pof_mem_thread_enter(PoFMemThreadTrace, POF_TRACE_STACK_SIZE);
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    PoFTraceWriter* writer = malloc(sizeof(PoFTraceWriter));
+    writer->file = storage_file_alloc(storage);
+    writer->written = 0;
+    writer->count = 0;
+    writer->ok = storage_file_open(writer->file, POF_TRACE_PATH, FSAM_WRITE, FSOM_CREATE_ALWAYS);
+    if (writer->ok) {
+        PoFTraceHeader header = {
+            .magic = POF_TRACE_MAGIC,
+            .version = POF_TRACE_VERSION,
+            .record_size = sizeof(PoFTraceRecord),
+            .cycles_per_us = furi_hal_cortex_instructions_per_microsecond(),
+        };
+        writer->ok = storage_file_write(writer->file, &header, sizeof(header)) == sizeof(header);
+    }
+
+    uint32_t tail = __atomic_load_n(&pof_trace_head, __ATOMIC_ACQUIRE);
+    if (writer->ok) {
+        __atomic_store_n(&pof_trace_enabled, true, __ATOMIC_RELEASE);
+    } else {
+        FURI_LOG_E(TAG, "Failed to open %s", POF_TRACE_PATH);
+        __atomic_store_n(&pof_trace_failed, true, __ATOMIC_RELEASE);
+    }
+    furi_semaphore_release(opened);
+    uint32_t lost = 0;
+    uint32_t lost_total = 0;
+    bool exit = false;
+    while (writer->ok && !exit) {
+        uint32_t flags =
+            furi_thread_flags_wait(PoFTraceEventExit, FuriFlagWaitAny, POF_TRACE_FLUSH_INTERVAL);
+        // Still drain once more on exit, for what was recorded before recording stopped
+        exit = !(flags & FuriFlagError) && (flags & PoFTraceEventExit);
+
+        PoFTraceRecord record;
+        PoFTraceTake take;
+        while ((take = pof_trace_take(&tail, &lost, &record)) != PoFTraceTakeEmpty) {
+            if (take == PoFTraceTakeRecord) {
+                // Mark the gap where it happened
+                lost_total += lost;
+                pof_trace_add_dropped(writer, &lost);
+                *pof_trace_next(writer) = record;
+            }
+        }
+        if (exit) {
+            lost_total += lost;
+            pof_trace_add_dropped(writer, &lost);
+        }
+        pof_trace_flush(writer);
+    }
+    if (!writer->ok) {
+        // Producers stop here, the UI finds out from pof_trace_has_failed
+        __atomic_store_n(&pof_trace_enabled, false, __ATOMIC_RELEASE);
+        __atomic_store_n(&pof_trace_failed, true, __ATOMIC_RELEASE);
+    }
+
+    FURI_LOG_I(TAG, "%lu records written, %lu dropped", writer->written, lost_total);
+    storage_file_close(writer->file);
+    storage_file_free(writer->file);
+    free(writer);
+    furi_record_close(RECORD_STORAGE);
+    pof_mem_thread_exit(PoFMemThreadTrace);
+    return 0;
+}
+
+bool pof_trace_start(void) {
+    if (pof_trace_is_running()) {
+        return true;
+    }
+    // A writer that stopped on an error is still around until joined
+    pof_trace_stop();
+    __atomic_store_n(&pof_trace_failed, false, __ATOMIC_RELEASE);
+
+    FuriSemaphore* opened = furi_semaphore_alloc(1, 0);
+    pof_trace_thread = furi_thread_alloc_ex("PoFTraceWriter", POF_TRACE_STACK_SIZE, pof_trace_worker, opened);
+    furi_thread_set_priority(pof_trace_thread, FuriThreadPriorityLow);
+    furi_thread_start(pof_trace_thread);
+    furi_semaphore_acquire(opened, FuriWaitForever);
+    furi_semaphore_free(opened);
+
+    if (pof_trace_has_failed()) {
+        pof_trace_stop();
+        return false;
+    }
+    return true;
+}
+
+void pof_trace_stop(void) {
+    if (!pof_trace_thread) {
+        return;
+    }
+    __atomic_store_n(&pof_trace_enabled, false, __ATOMIC_RELEASE);
+    furi_thread_flags_set(furi_thread_get_id(pof_trace_thread), PoFTraceEventExit);
+    furi_thread_join(pof_trace_thread);
+    furi_thread_free(pof_trace_thread);
+    pof_trace_thread = NULL;
+}
+
+bool pof_trace_is_running(void) {
+    return __atomic_load_n(&pof_trace_enabled, __ATOMIC_ACQUIRE);
+}
+
+bool pof_trace_has_failed(void) {
+    return __atomic_load_n(&pof_trace_failed, __ATOMIC_ACQUIRE);
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <furi.h>
+
+#define POF_TRACE_PATH APP_DATA_PATH("trace.bin")
+#define POF_TRACE_MAGIC 0x54464F50 // "POFT"
+#define POF_TRACE_VERSION 1
+#define POF_TRACE_DATA_SIZE 32
+
+typedef enum {
+    PoFTraceRx, // OUT endpoint read
+    PoFTraceTx, // IN endpoint write
+    PoFTraceControlSetup, // setup packet, then OUT data stage if any
+    PoFTraceControlIn, // data the control handler answered with
+    PoFTraceDropped, // length holds how many records were lost before this one
+} PoFTraceType;
+
+/*
+ * File layout, little endian: a PoFTraceHeader followed by PoFTraceRecord until the end.
+ * Records are in the order they were recorded, tick is furi_get_tick() in ms and cycles
+ * is DWT->CYCCNT at the same moment, for finer timing between neighbouring records.
+ */
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t record_size;
+    uint32_t cycles_per_us;
+} PoFTraceHeader;
+
+typedef struct {
+    uint32_t tick;
+    uint32_t cycles;
+    uint8_t type;
+    uint8_t endpoint;
+    uint16_t length; // full length, data only holds the first POF_TRACE_DATA_SIZE bytes
+    uint8_t data[POF_TRACE_DATA_SIZE];
+} PoFTraceRecord;
+
+// Starts the SD writer and waits for it to open the file, records are dropped until then.
+// False if the file couldn't be opened.
+bool pof_trace_start(void);
+// Flushes what is left and stops the writer
+void pof_trace_stop(void);
+// True while records are going to the file
+bool pof_trace_is_running(void);
+// The writer couldn't open or write the file, until the next start
+bool pof_trace_has_failed(void);
+
+// Safe from threads and interrupts, costs a copy of up to 32 bytes when running
+void pof_trace_record(PoFTraceType type, uint8_t endpoint, const uint8_t* data, uint16_t length);
@@ -8,6 +8,9 @@
 #include "usb.h"
 #include "usb_hid.h"
 #include "virtual_portal.h"
+#include "xsm3/xsm3.h"
+#include "pof_usb_queue.h"
+#include "pof_usb_scheduler.h"
 
 #define HID_REPORT_TYPE_INPUT   1
 #define HID_REPORT_TYPE_OUTPUT  2
@@ -19,17 +22,65 @@
 #define POF_USB_RX_MAX_SIZE (POF_USB_EP_OUT_SIZE)
 #define POF_USB_TX_MAX_SIZE (POF_USB_EP_IN_SIZE)
 
-#define TIMEOUT_NORMAL 32
-#define TIMEOUT_AFTER_RESPONSE 100
-#define TIMEOUT_AFTER_MUSIC 300
+#define HID_INTERVAL 1
+
+#define USB_EP0_SIZE 8
+
+#define POF_USB_VID (0x1430)
+
+#define POF_USB_EP_IN (0x81)
+#define POF_USB_EP_OUT (0x02)
+
+#define POF_USB_ACTUAL_OUTPUT_SIZE 0x20
 
 typedef struct PoFUsb PoFUsb;
 
-PoFUsb* pof_usb_start(VirtualPortal* virtual_portal);
+/* What arrived on the interrupt OUT endpoint */
+typedef enum {
+    PoFUsbFrameNone,
+    PoFUsbFrameCommand,
+    PoFUsbFrameAudio,
+} PoFUsbFrameType;
+
+/*
+ * Everything that differs between the emulated portals: descriptors,
+ * control requests and how portal frames are wrapped on the wire.
+ * The event loop, queueing and status timing in pof_usb.c are shared.
+ */
+typedef struct {
+    const struct usb_device_descriptor* dev_descr;
+    const void* cfg_descr;
+
+    // Bytes in front of every portal frame, written once into the preallocated tx frames
+    uint8_t header_size;
+    uint8_t header[2];
+
+    // Mode specific control requests, called from the USB interrupt
+    usbd_respond (*control)(PoFUsb* pof_usb, usbd_device* dev, usbd_ctlreq* req);
+    // Extra endpoints besides POF_USB_EP_IN / POF_USB_EP_OUT, may be NULL
+    void (*ep_config)(usbd_device* dev, uint8_t cfg);
+    // Finds the payload in a frame received on the OUT endpoint
+    PoFUsbFrameType (*classify)(uint8_t* buf, uint32_t len, uint8_t** payload, uint32_t* payload_len);
+    void (*audio)(VirtualPortal* virtual_portal, uint8_t* message, uint8_t len);
+    // Work the control handler handed off with pof_usb_defer, runs on the worker. May be NULL
+    void (*deferred)(PoFUsb* pof_usb);
+    // How often status frames go out, see pof_usb_scheduler.h
+    const PoFStatusProfile* status_profile;
+} PoFUsbMode;
+
+extern const PoFUsbMode pof_usb_mode_hid;
+extern const PoFUsbMode pof_usb_mode_xbox360;
+
+PoFUsb* pof_usb_start(VirtualPortal* virtual_portal, const PoFUsbMode* mode);
 void pof_usb_stop(PoFUsb* pof);
 
-PoFUsb* pof_usb_start_xbox360(VirtualPortal* virtual_portal);
-void pof_usb_stop_xbox360(PoFUsb* pof);
+// Hands a command received over EP0 to the worker, safe to call from the control callback
+void pof_usb_command_received(PoFUsb* pof_usb, const uint8_t* data, uint16_t len);
+// Runs mode->deferred on the worker, for work too slow for the control callback
+void pof_usb_defer(PoFUsb* pof_usb);
+
+// Keys derived for the consoles seen in Xbox 360 mode, only touch while the mode is stopped
+Xsm3KeyCache* pof_usb_xbox360_key_cache(void);
 
 /*descriptor type*/
 typedef enum {
@@ -92,6 +143,7 @@ typedef enum {
 
 struct PoFUsb {
     FuriHalUsbInterface usb;
+    const PoFUsbMode* mode;
     FuriHalUsbInterface* usb_prev;
 
     FuriThread* thread;
@@ -100,11 +152,27 @@ struct PoFUsb {
     uint8_t data_recvest[8];
     uint16_t data_recvest_len;
 
-    bool tx_complete;
-    bool tx_immediate;
+    PoFUsbQueue tx_queue;
+    PoFStatusScheduler scheduler;
+    const PoFStatusProfile* status_profile;
+
+    // Longest time spent in a control request handler, in CPU cycles
+    uint32_t control_cycles_max;
+    // DWT->CYCCNT when the last command came in over the OUT endpoint / EP0
+    volatile uint32_t rx_cycles;
+    volatile uint32_t data_cycles;
+    // When the last status frame went to the IN endpoint
+    bool status_written;
+    uint32_t status_tick;
+    uint32_t status_cycles;
 
     uint8_t dataAvailable;
     uint8_t data[POF_USB_RX_MAX_SIZE];
 
     uint8_t tx_data[POF_USB_TX_MAX_SIZE];
+
+    // Preallocated frames with the mode header in place, the portal writes straight after it.
+    // Status gets its own frame so the bytes after the 7 status bytes stay zero.
+    uint8_t tx_response[POF_USB_TX_MAX_SIZE];
+    uint8_t tx_status[POF_USB_TX_MAX_SIZE];
 };
\ No newline at end of file
@@ -0,0 +1,175 @@
+#include "pof_usb.h"
+
+#define TAG "POF USB HID"
+
+#define POF_USB_PID (0x0150)
+
+static const uint8_t hid_report_desc[] = {0x06, 0x00, 0xFF, 0x09, 0x01, 0xA1, 0x01, 0x19,
+                                          0x01, 0x29, 0x40, 0x15, 0x00, 0x26, 0xFF, 0x00,
+                                          0x75, 0x08, 0x95, 0x20, 0x81, 0x00, 0x19, 0x01,
+                                          0x29, 0x40, 0x91, 0x00, 0xC0};
+
+struct PoFUsbDescriptor {
+    struct usb_config_descriptor config;
+    struct usb_interface_descriptor intf;
+    struct usb_hid_descriptor hid_desc;
+    struct usb_endpoint_descriptor ep_in;
+    struct usb_endpoint_descriptor ep_out;
+} __attribute__((packed));
+
+static const struct usb_device_descriptor usb_pof_dev_descr = {
+    .bLength = sizeof(struct usb_device_descriptor),
+    .bDescriptorType = USB_DTYPE_DEVICE,
+    .bcdUSB = VERSION_BCD(2, 0, 0),
+    .bDeviceClass = USB_CLASS_PER_INTERFACE,
+    .bDeviceSubClass = USB_SUBCLASS_NONE,
+    .bDeviceProtocol = USB_PROTO_NONE,
+    .bMaxPacketSize0 = USB_EP0_SIZE,
+    .idVendor = POF_USB_VID,
+    .idProduct = POF_USB_PID,
+    .bcdDevice = VERSION_BCD(1, 0, 0),
+    .iManufacturer = 1,  // UsbDevManuf
+    .iProduct = 2,       // UsbDevProduct
+    .iSerialNumber = 0,
+    .bNumConfigurations = 1,
+};
+
+static const struct PoFUsbDescriptor usb_pof_cfg_descr = {
+    .config =
+        {
+            .bLength = sizeof(struct usb_config_descriptor),
+            .bDescriptorType = USB_DTYPE_CONFIGURATION,
+            .wTotalLength = sizeof(struct PoFUsbDescriptor),
+            .bNumInterfaces = 1,
+            .bConfigurationValue = 1,
+            .iConfiguration = NO_DESCRIPTOR,
+            .bmAttributes = USB_CFG_ATTR_RESERVED,
+            .bMaxPower = USB_CFG_POWER_MA(500),
+        },
+    .intf =
+        {
+            .bLength = sizeof(struct usb_interface_descriptor),
+            .bDescriptorType = USB_DTYPE_INTERFACE,
+            .bInterfaceNumber = 0,
+            .bAlternateSetting = 0,
+            .bNumEndpoints = 2,
+            .bInterfaceClass = USB_CLASS_HID,
+            .bInterfaceSubClass = USB_HID_SUBCLASS_NONBOOT,
+            .bInterfaceProtocol = USB_HID_PROTO_NONBOOT,
+            .iInterface = NO_DESCRIPTOR,
+        },
+    .hid_desc =
+        {
+            .bLength = sizeof(struct usb_hid_descriptor),
+            .bDescriptorType = USB_DTYPE_HID,
+            .bcdHID = VERSION_BCD(1, 1, 1),
+            .bCountryCode = USB_HID_COUNTRY_NONE,
+            .bNumDescriptors = 1,
+            .bDescriptorType0 = USB_DTYPE_HID_REPORT,
+            .wDescriptorLength0 = sizeof(hid_report_desc),
+        },
+    .ep_in =
+        {
+            .bLength = sizeof(struct usb_endpoint_descriptor),
+            .bDescriptorType = USB_DTYPE_ENDPOINT,
+            .bEndpointAddress = POF_USB_EP_IN,
+            .bmAttributes = USB_EPTYPE_INTERRUPT,
+            .wMaxPacketSize = 0x40,
+            .bInterval = HID_INTERVAL,
+        },
+    .ep_out =
+        {
+            .bLength = sizeof(struct usb_endpoint_descriptor),
+            .bDescriptorType = USB_DTYPE_ENDPOINT,
+            .bEndpointAddress = POF_USB_EP_OUT,
+            .bmAttributes = USB_EPTYPE_INTERRUPT,
+            .wMaxPacketSize = 0x40,
+            .bInterval = HID_INTERVAL,
+        },
+};
+
+/* Control requests handler */
+static usbd_respond pof_hid_control(PoFUsb* pof_usb, usbd_device* dev, usbd_ctlreq* req) {
+    uint8_t wValueH = req->wValue >> 8;
+    uint16_t length = req->wLength;
+
+    /* HID control requests */
+    if (((USB_REQ_RECIPIENT | USB_REQ_TYPE) & req->bmRequestType) ==
+            (USB_REQ_INTERFACE | USB_REQ_CLASS) &&
+        req->wIndex == 0) {
+        switch (req->bRequest) {
+            case USB_HID_SETIDLE:
+                return usbd_ack;
+            case USB_HID_SETPROTOCOL:
+                return usbd_ack;
+            case USB_HID_GETREPORT:
+                dev->status.data_ptr = pof_usb->tx_data;
+                dev->status.data_count = sizeof(pof_usb->tx_data);
+                return usbd_ack;
+            case USB_HID_SETREPORT:
+                if (wValueH == HID_REPORT_TYPE_INPUT) {
+                    if (length == POF_USB_RX_MAX_SIZE) {
+                        return usbd_ack;
+                    }
+                } else if (wValueH == HID_REPORT_TYPE_OUTPUT) {
+                    pof_usb_command_received(pof_usb, req->data, req->wLength);
+
+                    return usbd_ack;
+                } else if (wValueH == HID_REPORT_TYPE_FEATURE) {
+                    return usbd_ack;
+                }
+                return usbd_fail;
+            default:
+                return usbd_fail;
+        }
+    }
+
+    if (((USB_REQ_RECIPIENT | USB_REQ_TYPE) & req->bmRequestType) ==
+            (USB_REQ_INTERFACE | USB_REQ_STANDARD) &&
+        req->wIndex == 0 && req->bRequest == USB_STD_GET_DESCRIPTOR) {
+        switch (wValueH) {
+            case USB_DTYPE_HID:
+                dev->status.data_ptr = (uint8_t*)&(usb_pof_cfg_descr.hid_desc);
+                dev->status.data_count = sizeof(usb_pof_cfg_descr.hid_desc);
+                return usbd_ack;
+            case USB_DTYPE_HID_REPORT:
+                dev->status.data_ptr = (uint8_t*)hid_report_desc;
+                dev->status.data_count = sizeof(hid_report_desc);
+                return usbd_ack;
+            default:
+                return usbd_fail;
+        }
+    }
+    return usbd_fail;
+}
+
+// Commands are 32 byte reports, anything else on the OUT endpoint is 64 byte audio frames.
+// Some hosts send commands this way instead of SET_REPORT.
+static PoFUsbFrameType
+    pof_hid_classify(uint8_t* buf, uint32_t len, uint8_t** payload, uint32_t* payload_len) {
+    *payload = buf;
+    *payload_len = len;
+    if (len == POF_USB_ACTUAL_OUTPUT_SIZE) {
+        return PoFUsbFrameCommand;
+    }
+    return len > 0 ? PoFUsbFrameAudio : PoFUsbFrameNone;
+}
+
+// https://github.com/xMasterX/all-the-plugins/blob/dev/base_pack/wav_player/wav_player_hal.c
+static void pof_hid_audio(VirtualPortal* virtual_portal, uint8_t* message, uint8_t len) {
+    if (virtual_portal->speaker) {
+        virtual_portal_process_audio(virtual_portal, message, len);
+    }
+}
+
+const PoFUsbMode pof_usb_mode_hid = {
+    .dev_descr = &usb_pof_dev_descr,
+    .cfg_descr = &usb_pof_cfg_descr,
+    .header_size = 0,
+    .control = pof_hid_control,
+    .ep_config = NULL,
+    .classify = pof_hid_classify,
+    .audio = pof_hid_audio,
+    .deferred = NULL,
+    .status_profile = &pof_status_profile_default,
+};
@@ -0,0 +1,94 @@
+#include "pof_usb_queue.h"
+
+#include <string.h>
+
+// Odd bits of the four status bytes flag slots that changed since the last status
+#define POF_STATUS_CHANGE_MASK 0xAA
+
+void pof_usb_queue_reset(PoFUsbQueue* queue, uint8_t payload_offset) {
+    queue->head = 0;
+    queue->count = 0;
+    queue->status_pending = false;
+    queue->payload_offset = payload_offset;
+    queue->busy = false;
+    queue->depth = 0;
+}
+
+bool pof_usb_queue_push(
+    PoFUsbQueue* queue,
+    const uint8_t* data,
+    uint16_t len,
+    bool status,
+    uint8_t command,
+    uint32_t received) {
+    if (len > POF_USB_QUEUE_FRAME_SIZE) {
+        len = POF_USB_QUEUE_FRAME_SIZE;
+    }
+
+    if (status) {
+        if (queue->status_pending) {
+            // Replace the stale status, but keep the change bits it was carrying
+            uint8_t* slots = queue->status.data + queue->payload_offset + 1;
+            uint8_t changed[4];
+            for (int i = 0; i < 4; i++) {
+                changed[i] = slots[i] & POF_STATUS_CHANGE_MASK;
+            }
+            memcpy(queue->status.data, data, len);
+            for (int i = 0; i < 4; i++) {
+                slots[i] |= changed[i];
+            }
+            queue->coalesced++;
+        } else {
+            memcpy(queue->status.data, data, len);
+            queue->status_pending = true;
+            queue->depth++;
+        }
+        queue->status.len = len;
+        queue->status.command = 0;
+        queue->status.received = received;
+    } else {
+        if (queue->count == POF_USB_QUEUE_DEPTH) {
+            queue->dropped++;
+            return false;
+        }
+        PoFUsbFrame* frame = &queue->responses[(queue->head + queue->count) % POF_USB_QUEUE_DEPTH];
+        memcpy(frame->data, data, len);
+        frame->len = len;
+        frame->command = command;
+        frame->received = received;
+        queue->count++;
+        queue->depth++;
+    }
+
+    if (queue->depth > queue->depth_max) {
+        queue->depth_max = queue->depth;
+    }
+    return true;
+}
+
+const PoFUsbFrame* pof_usb_queue_pop(PoFUsbQueue* queue) {
+    if (queue->busy) {
+        return NULL;
+    }
+
+    const PoFUsbFrame* frame = NULL;
+    if (queue->count) {
+        frame = &queue->responses[queue->head];
+        queue->head = (queue->head + 1) % POF_USB_QUEUE_DEPTH;
+        queue->count--;
+    } else if (queue->status_pending) {
+        frame = &queue->status;
+        queue->status_pending = false;
+    }
+
+    if (frame) {
+        queue->depth--;
+        queue->sent++;
+        queue->busy = true;
+    }
+    return frame;
+}
+
+void pof_usb_queue_tx_complete(PoFUsbQueue* queue) {
+    queue->busy = false;
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define POF_USB_QUEUE_FRAME_SIZE (64UL)
+#define POF_USB_QUEUE_DEPTH 4
+
+typedef struct {
+    uint8_t data[POF_USB_QUEUE_FRAME_SIZE];
+    uint16_t len;
+    // Command a response answers and DWT->CYCCNT when it came in, for latency stats
+    uint8_t command;
+    uint32_t received;
+} PoFUsbFrame;
+
+/*
+ * Frames waiting for the interrupt IN endpoint. Command responses are sent in
+ * order and always go before status frames. Only the newest status frame is
+ * kept, older ones are merged into it so that no change bits are lost.
+ * Only the USB worker thread touches the queue.
+ */
+typedef struct {
+    PoFUsbFrame responses[POF_USB_QUEUE_DEPTH];
+    uint8_t head;
+    uint8_t count;
+
+    PoFUsbFrame status;
+    bool status_pending;
+    // Offset of the portal payload inside a frame, for transports with a header
+    uint8_t payload_offset;
+
+    // Set while the endpoint holds a frame the host hasn't read yet
+    bool busy;
+
+    uint32_t depth;
+    uint32_t depth_max;
+    uint32_t sent;
+    uint32_t dropped;
+    uint32_t coalesced;
+} PoFUsbQueue;
+
+void pof_usb_queue_reset(PoFUsbQueue* queue, uint8_t payload_offset);
+
+// Status frames are pushed with command 0
+bool pof_usb_queue_push(
+    PoFUsbQueue* queue,
+    const uint8_t* data,
+    uint16_t len,
+    bool status,
+    uint8_t command,
+    uint32_t received);
+
+// Next frame to write if the endpoint is free, marks the endpoint busy
+const PoFUsbFrame* pof_usb_queue_pop(PoFUsbQueue* queue);
+
+void pof_usb_queue_tx_complete(PoFUsbQueue* queue);
@@ -0,0 +1,101 @@
+#include "pof_usb_scheduler.h"
+
+#include <furi.h>
+#include <string.h>
+
+#define TAG "PoFStatus"
+
+const PoFStatusProfile pof_status_profile_default = {
+    .idle = TIMEOUT_NORMAL,
+    .after_response = TIMEOUT_AFTER_RESPONSE,
+    .audio = TIMEOUT_AFTER_MUSIC,
+};
+
+static void pof_status_jitter_reset(PoFStatusJitter* jitter) {
+    memset(jitter, 0, sizeof(PoFStatusJitter));
+    jitter->interval_min = UINT32_MAX;
+}
+
+static void pof_status_jitter_report(PoFStatusScheduler* scheduler, uint32_t now) {
+    PoFStatusJitter* jitter = &scheduler->jitter;
+    if (jitter->count) {
+        FURI_LOG_I(
+            TAG,
+            "%lu status, late avg %lu max %lu ms, interval %lu..%lu ms",
+            jitter->count,
+            (uint32_t)(jitter->late_sum / jitter->count),
+            jitter->late_max,
+            jitter->interval_min,
+            jitter->interval_max);
+    }
+    pof_status_jitter_reset(jitter);
+    scheduler->report_at = now + POF_STATUS_REPORT_INTERVAL;
+}
+
+void pof_status_scheduler_init(
+    PoFStatusScheduler* scheduler,
+    const PoFStatusProfile* profile,
+    uint32_t now) {
+    scheduler->profile = profile;
+    scheduler->deadline = now + profile->idle;
+    scheduler->last_sent = now;
+    scheduler->report_at = now + POF_STATUS_REPORT_INTERVAL;
+    pof_status_jitter_reset(&scheduler->jitter);
+}
+
+void pof_status_scheduler_resume(PoFStatusScheduler* scheduler, uint32_t now) {
+    // Keep the hold-off from the activate response, only drop a deadline that went stale while idle
+    if (pof_status_scheduler_due(scheduler, now)) {
+        scheduler->deadline = now + scheduler->profile->idle;
+    }
+    scheduler->last_sent = now;
+}
+
+uint32_t pof_status_scheduler_timeout(const PoFStatusScheduler* scheduler, uint32_t now) {
+    int32_t remaining = (int32_t)(scheduler->deadline - now);
+    return remaining > 0 ? (uint32_t)remaining : 0;
+}
+
+bool pof_status_scheduler_due(const PoFStatusScheduler* scheduler, uint32_t now) {
+    return (int32_t)(now - scheduler->deadline) >= 0;
+}
+
+void pof_status_scheduler_advance(
+    PoFStatusScheduler* scheduler,
+    uint32_t now,
+    bool audio,
+    bool sent) {
+    if (sent) {
+        PoFStatusJitter* jitter = &scheduler->jitter;
+        uint32_t late = now - scheduler->deadline;
+        uint32_t interval = now - scheduler->last_sent;
+        jitter->count++;
+        jitter->late_sum += late;
+        if (late > jitter->late_max) {
+            jitter->late_max = late;
+        }
+        if (interval < jitter->interval_min) {
+            jitter->interval_min = interval;
+        }
+        if (interval > jitter->interval_max) {
+            jitter->interval_max = interval;
+        }
+        scheduler->last_sent = now;
+    }
+
+    uint32_t period = audio ? scheduler->profile->audio : scheduler->profile->idle;
+    scheduler->deadline += period;
+    // Fell more than a whole period behind, resync instead of sending a burst
+    if (pof_status_scheduler_due(scheduler, now)) {
+        scheduler->deadline = now + period;
+    }
+
+    if ((int32_t)(now - scheduler->report_at) >= 0) {
+        pof_status_jitter_report(scheduler, now);
+    }
+}
+
+void pof_status_scheduler_response(PoFStatusScheduler* scheduler, uint32_t now, bool audio) {
+    scheduler->deadline =
+        now + (audio ? scheduler->profile->audio : scheduler->profile->after_response);
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define TIMEOUT_NORMAL 32
+#define TIMEOUT_AFTER_RESPONSE 100
+#define TIMEOUT_AFTER_MUSIC 300
+
+// Jitter summary is logged this often
+#define POF_STATUS_REPORT_INTERVAL (10 * 60 * 1000)
+
+/*
+ * Status cadence for each portal state, in ms.
+ * idle:           between two status frames
+ * after_response: from a command response to the next status
+ * audio:          between status frames while the speaker is on
+ */
+typedef struct {
+    uint32_t idle;
+    uint32_t after_response;
+    uint32_t audio;
+} PoFStatusProfile;
+
+typedef struct {
+    uint32_t count;
+    // How late a status went out compared to its deadline
+    uint32_t late_max;
+    uint64_t late_sum;
+    // Time between two consecutive status frames
+    uint32_t interval_min;
+    uint32_t interval_max;
+} PoFStatusJitter;
+
+typedef struct {
+    const PoFStatusProfile* profile;
+    // Absolute tick the next status is due at
+    uint32_t deadline;
+    uint32_t last_sent;
+    uint32_t report_at;
+    PoFStatusJitter jitter;
+} PoFStatusScheduler;
+
+// 32/100/300 ms, what both portals have always used
+extern const PoFStatusProfile pof_status_profile_default;
+
+void pof_status_scheduler_init(
+    PoFStatusScheduler* scheduler,
+    const PoFStatusProfile* profile,
+    uint32_t now);
+
+// Portal just became active, restart the cadence from now
+void pof_status_scheduler_resume(PoFStatusScheduler* scheduler, uint32_t now);
+
+// Ticks to wait until the next deadline, 0 if it has already passed
+uint32_t pof_status_scheduler_timeout(const PoFStatusScheduler* scheduler, uint32_t now);
+
+bool pof_status_scheduler_due(const PoFStatusScheduler* scheduler, uint32_t now);
+
+// Deadline was handled, schedule the next one from the old deadline so the period doesn't drift.
+// Jitter is only recorded when a status frame actually went out.
+void pof_status_scheduler_advance(
+    PoFStatusScheduler* scheduler,
+    uint32_t now,
+    bool audio,
+    bool sent);
+
+// A command response went out, the next status is held back
+void pof_status_scheduler_response(PoFStatusScheduler* scheduler, uint32_t now, bool audio);
@@ -3,6 +3,7 @@
 
 #include <portal_of_flipper_icons.h>
 #include "pof_token.h"
+#include "helpers/pof_probe.h"
 
 #define TAG "PoFToken"
 
@@ -16,7 +17,7 @@ PoFToken* pof_token_alloc() {
     pof_token->load_path = furi_string_alloc();
     pof_token->loaded = false;
     pof_token->change = false;
-    pof_token->nfc_device = nfc_device_alloc();
+    pof_token->image = NULL;
     memset(pof_token->UID, 0, sizeof(pof_token->UID));
     return pof_token;
 }
@@ -27,6 +28,23 @@ void pof_token_set_name(PoFToken* pof_token, const char* name) {
     strlcpy(pof_token->dev_name, name, sizeof(pof_token->dev_name));
 }
 
+// Figures are named after their file
+static void pof_token_name_from_path(PoFToken* pof_token) {
+    FuriString* filename = furi_string_alloc();
+    path_extract_filename(pof_token->load_path, filename, true);
+    pof_token_set_name(pof_token, furi_string_get_cstr(filename));
+    furi_string_free(filename);
+}
+
+// Takes over the reference to image
+static void pof_token_set_image(PoFToken* pof_token, PoFImage* image) {
+    PoFImage* previous = pof_token->image;
+    pof_token->image = image;
+    if(previous) {
+        pof_image_release(previous);
+    }
+}
+
 static bool pof_token_load_data(PoFToken* pof_token, FuriString* path, bool show_dialog) {
     FuriString* reason = furi_string_alloc_set("Couldn't load file");
 
@@ -34,8 +52,8 @@ static bool pof_token_load_data(PoFToken* pof_token, FuriString* path, bool show
         pof_token->loading_cb(pof_token->loading_cb_ctx, true);
     }
 
+    NfcDevice* nfc_device = nfc_device_alloc();
     do {
-        NfcDevice* nfc_device = pof_token->nfc_device;
         if(!nfc_device_load(nfc_device, furi_string_get_cstr(path))) break;
 
         NfcProtocol protocol = nfc_device_get_protocol(nfc_device);
@@ -59,10 +77,16 @@ static bool pof_token_load_data(PoFToken* pof_token, FuriString* path, bool show
         size_t uid_len = 0;
         const uint8_t* uid = nfc_device_get_uid(nfc_device, &uid_len);
         memcpy(pof_token->UID, uid, sizeof(pof_token->UID));
+        pof_token_set_image(pof_token, pof_image_acquire(nfc_device));
+        nfc_device = NULL;
         pof_token->loaded = true;
         pof_token->change = true;
     } while(false);
 
+    if(nfc_device) {
+        nfc_device_free(nfc_device);
+    }
+
     if(pof_token->loading_cb) {
         pof_token->loading_cb(pof_token->loading_cb_ctx, false);
     }
@@ -78,15 +102,19 @@ static bool pof_token_load_data(PoFToken* pof_token, FuriString* path, bool show
 
 void pof_token_clear(PoFToken* pof_token, bool save) {
     furi_assert(pof_token);
-    if(save) {
+    if(save && pof_token->image) {
         // Saving during app clean up causes a crash
-        nfc_device_save(pof_token->nfc_device, furi_string_get_cstr(pof_token->load_path));
+        uint32_t probe_start = pof_probe_start();
+        pof_image_save(pof_token->image, furi_string_get_cstr(pof_token->load_path));
+        pof_probe_end(PoFProbeNfcSave, probe_start);
     }
-    nfc_device_clear(pof_token->nfc_device);
     furi_string_reset(pof_token->load_path);
     memset(pof_token->dev_name, 0, sizeof(pof_token->dev_name));
     pof_token->loaded = false;
+    pof_token_set_image(pof_token, NULL);
     pof_token->change = true;
+    pof_token->dirty = false;
+    pof_figure_reset(&pof_token->figure);
 }
 
 void pof_token_free(PoFToken* pof_token) {
@@ -95,7 +123,6 @@ void pof_token_free(PoFToken* pof_token) {
     furi_record_close(RECORD_STORAGE);
     furi_record_close(RECORD_DIALOGS);
     furi_string_free(pof_token->load_path);
-    nfc_device_free(pof_token->nfc_device);
     free(pof_token);
 }
 
@@ -120,20 +147,45 @@ bool pof_file_select(PoFToken* pof_token) {
 
     furi_string_free(pof_app_folder);
     if(res) {
-        FuriString* filename;
-        filename = furi_string_alloc();
-        path_extract_filename(pof_token->load_path, filename, true);
-        strlcpy(pof_token->dev_name, furi_string_get_cstr(filename), sizeof(pof_token->dev_name));
+        pof_token_name_from_path(pof_token);
         res = pof_token_load_data(pof_token, pof_token->load_path, true);
-        if(res) {
-            pof_token_set_name(pof_token, pof_token->dev_name);
-        }
-        furi_string_free(filename);
     }
 
     return res;
 }
 
+bool pof_token_load_path(PoFToken* pof_token, const char* path) {
+    furi_assert(pof_token);
+
+    furi_string_set_str(pof_token->load_path, path);
+    pof_token_name_from_path(pof_token);
+    bool res = pof_token_load_data(pof_token, pof_token->load_path, false);
+    if(!res) {
+        FURI_LOG_W(TAG, "Couldn't load %s", path);
+    }
+    return res;
+}
+
+void pof_token_set_data(PoFToken* pof_token, const char* path, const MfClassicData* data) {
+    furi_assert(pof_token);
+    furi_assert(data);
+
+    furi_string_set_str(pof_token->load_path, path);
+    pof_token_name_from_path(pof_token);
+    NfcDevice* nfc_device = nfc_device_alloc();
+    nfc_device_set_data(nfc_device, NfcProtocolMfClassic, data);
+    pof_token_set_image(pof_token, pof_image_acquire(nfc_device));
+    memcpy(pof_token->UID, data->iso14443_3a_data->uid, sizeof(pof_token->UID));
+    pof_token->loaded = true;
+    pof_token->change = true;
+}
+
+void pof_token_set_image_ref(PoFToken* pof_token, PoFImage* image) {
+    furi_assert(pof_token);
+
+    pof_token_set_image(pof_token, image ? pof_image_ref(image) : NULL);
+}
+
 void pof_token_set_loading_callback(
     PoFToken* pof_token,
     PoFLoadingCallback callback,
@@ -7,6 +7,9 @@
 #include <lib/nfc/nfc_device.h>
 #include <lib/nfc/protocols/mf_classic/mf_classic.h>
 
+#include "helpers/pof_figure.h"
+#include "helpers/pof_image.h"
+
 #define POF_TOKEN_NAME_MAX_LEN 129
 
 typedef void (*PoFLoadingCallback)(void* context, bool state);
@@ -20,8 +23,14 @@ typedef struct {
     char dev_name[POF_TOKEN_NAME_MAX_LEN];
     bool change;
     bool loaded;
-    NfcDevice* nfc_device;
+    // Written by the game since it was loaded
+    bool dirty;
+    // Being saved back to its file
+    bool writing;
+    // NULL while not loaded, may be shared with other tokens
+    PoFImage* image;
     uint8_t UID[4];
+    PoFFigure figure;
 } PoFToken;
 
 PoFToken* pof_token_alloc();
@@ -32,6 +41,13 @@ void pof_token_set_name(PoFToken* pof_token, const char* name);
 
 bool pof_file_select(PoFToken* pof_token);
 
+// Loads a figure file without asking, failures are only logged
+bool pof_token_load_path(PoFToken* pof_token, const char* path);
+// Like pof_token_load_path, for data that was already read from path
+void pof_token_set_data(PoFToken* pof_token, const char* path, const MfClassicData* data);
+// Shares image with the token, replacing what it held
+void pof_token_set_image_ref(PoFToken* pof_token, PoFImage* image);
+
 void pof_token_clear(PoFToken* pof_token, bool save);
 
 void pof_token_set_loading_callback(PoFToken* dev, PoFLoadingCallback callback, void* context);
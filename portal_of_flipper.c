@@ -1,5 +1,9 @@
 #include <furi.h>
 #include "portal_of_flipper_i.h"
+#include "helpers/pof_mem.h"
+
+// Matches stack_size in application.fam
+#define POF_APP_STACK_SIZE (5 * 1024)
 
 static bool pof_app_custom_event_callback(void* context, uint32_t event) {
     furi_assert(context);
@@ -32,6 +36,7 @@ void pof_show_loading_popup(void* context, bool show) {
 }
 
 PoFApp* pof_app_alloc() {
+    size_t heap = pof_mem_heap_begin();
     PoFApp* app = malloc(sizeof(PoFApp));
 
     // GUI
@@ -69,6 +74,12 @@ PoFApp* pof_app_alloc() {
     app->widget = widget_alloc();
     view_dispatcher_add_view(app->view_dispatcher, PoFViewWidget, widget_get_view(app->widget));
 
+    // Dashboard
+    app->dashboard = pof_dashboard_alloc();
+    view_dispatcher_add_view(
+        app->view_dispatcher, PoFViewDashboard, pof_dashboard_get_view(app->dashboard));
+    pof_mem_heap_end(PoFMemUi, heap);
+
     app->virtual_portal = virtual_portal_alloc(app->notifications);
 
     scene_manager_next_scene(app->scene_manager, PoFSceneTypeSelect);
@@ -80,6 +91,8 @@ void pof_app_free(PoFApp* app) {
 
     // PoF emulation Stop
     pof_stop(app);
+    // Every thread has reported its stack by now
+    pof_mem_log();
 
     // Clean up peripherals like LEDs 
     virtual_portal_cleanup(app->virtual_portal);
@@ -100,6 +113,10 @@ void pof_app_free(PoFApp* app) {
     view_dispatcher_remove_view(app->view_dispatcher, PoFViewWidget);
     widget_free(app->widget);
 
+    // Dashboard
+    view_dispatcher_remove_view(app->view_dispatcher, PoFViewDashboard);
+    pof_dashboard_free(app->dashboard);
+
     // View dispatcher
     view_dispatcher_free(app->view_dispatcher);
     scene_manager_free(app->scene_manager);
@@ -115,16 +132,22 @@ void pof_app_free(PoFApp* app) {
     app->virtual_portal = NULL;
 
     free(app);
+    pof_mem_heap_release(PoFMemUi);
 }
 
 int32_t portal_of_flipper_app(void* p) {
     UNUSED(p);
+    pof_mem_init();
+    pof_mem_thread_enter(PoFMemThreadApp, POF_APP_STACK_SIZE);
 
     PoFApp* pof_app = pof_app_alloc();
+    pof_mem_log();
 
     view_dispatcher_run(pof_app->view_dispatcher);
 
+    pof_mem_thread_exit(PoFMemThreadApp);
     pof_app_free(pof_app);
+    pof_mem_deinit();
 
     return 0;
 }
@@ -1,27 +1,105 @@
 #include "portal_of_flipper_i.h"
 
 #include <furi.h>
+#include <storage/storage.h>
+
+#include "helpers/pof_log.h"
+#include "helpers/pof_mem.h"
+#include "helpers/pof_probe.h"
+#include "helpers/pof_session.h"
+#include "helpers/pof_trace.h"
 
 #define TAG "PoF"
 
+#define POF_XSM3_KEYS_PATH APP_DATA_PATH("xsm3_keys.bin")
+#define POF_XSM3_KEYS_MAGIC 0x4B335358 // "XS3K"
+#define POF_XSM3_KEYS_VERSION 1
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t size;
+} PoFXsm3KeysHeader;
+
+// Consoles seen before skip the key derivation on every replug
+static void pof_xsm3_keys_load(Xsm3KeyCache* cache) {
+    xsm3_key_cache_init(cache);
+
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    File* file = storage_file_alloc(storage);
+    if (storage_file_open(file, POF_XSM3_KEYS_PATH, FSAM_READ, FSOM_OPEN_EXISTING)) {
+        PoFXsm3KeysHeader header;
+        bool ok = storage_file_read(file, &header, sizeof(header)) == sizeof(header) &&
+                  header.magic == POF_XSM3_KEYS_MAGIC &&
+                  header.version == POF_XSM3_KEYS_VERSION &&
+                  header.size == sizeof(Xsm3KeyCache) &&
+                  storage_file_read(file, cache, sizeof(Xsm3KeyCache)) == sizeof(Xsm3KeyCache);
+        if (!ok) {
+            FURI_LOG_W(TAG, "Ignoring bad key cache");
+            xsm3_key_cache_init(cache);
+        }
+        cache->dirty = false;
+    }
+    storage_file_close(file);
+    storage_file_free(file);
+    furi_record_close(RECORD_STORAGE);
+}
+
+static void pof_xsm3_keys_save(Xsm3KeyCache* cache) {
+    if (!cache->dirty) {
+        return;
+    }
+
+    Storage* storage = furi_record_open(RECORD_STORAGE);
+    File* file = storage_file_alloc(storage);
+    if (storage_file_open(file, POF_XSM3_KEYS_PATH, FSAM_WRITE, FSOM_CREATE_ALWAYS)) {
+        PoFXsm3KeysHeader header = {
+            .magic = POF_XSM3_KEYS_MAGIC,
+            .version = POF_XSM3_KEYS_VERSION,
+            .size = sizeof(Xsm3KeyCache),
+        };
+        cache->dirty = false;
+        if (storage_file_write(file, &header, sizeof(header)) != sizeof(header) ||
+           storage_file_write(file, cache, sizeof(Xsm3KeyCache)) != sizeof(Xsm3KeyCache)) {
+            FURI_LOG_E(TAG, "Failed to save key cache");
+        }
+    }
+    storage_file_close(file);
+    storage_file_free(file);
+    furi_record_close(RECORD_STORAGE);
+}
+
 void pof_start(PoFApp* app) {
     furi_assert(app);
 
-    if (app->virtual_portal->type == PoFHid) {
-        app->pof_usb = pof_usb_start(app->virtual_portal);
-    }
+    const PoFUsbMode* mode = &pof_usb_mode_hid;
     if (app->virtual_portal->type == PoFXbox360) {
-        app->pof_usb = pof_usb_start_xbox360(app->virtual_portal);
+        mode = &pof_usb_mode_xbox360;
+        pof_xsm3_keys_load(pof_usb_xbox360_key_cache());
     }
+    pof_probe_latency_load();
+    pof_log_start();
+    size_t heap = pof_mem_heap_begin();
+    app->pof_usb = pof_usb_start(app->virtual_portal, mode);
+    pof_mem_heap_end(PoFMemUsb, heap);
+    // Figures arrive while the console enumerates the portal
+    pof_session_restore_start(app->virtual_portal);
 }
 
 void pof_stop(PoFApp* app) {
     furi_assert(app);
 
-    if (app->virtual_portal->type == PoFHid) {
-        pof_usb_stop(app->pof_usb);
+    bool restored = pof_session_restore_stop();
+    pof_usb_stop(app->pof_usb);
+    pof_mem_heap_release(PoFMemUsb);
+    // Only once started, otherwise there is nothing on the portal worth keeping
+    if (app->pof_usb && restored) {
+        pof_session_save(app->virtual_portal);
     }
+    pof_trace_stop();
+    pof_log_stop();
+    pof_probe_latency_save();
     if (app->virtual_portal->type == PoFXbox360) {
-        pof_usb_stop_xbox360(app->pof_usb);
+        pof_xsm3_keys_save(pof_usb_xbox360_key_cache());
     }
 }
@@ -16,6 +16,7 @@
 
 #include "helpers/pof_usb.h"
 #include "virtual_portal.h"
+#include "views/pof_dashboard.h"
 
 typedef struct PoFApp PoFApp;
 
@@ -28,6 +29,7 @@ struct PoFApp {
     Popup* popup;
     Loading* loading;
     Widget* widget;
+    PoFDashboard* dashboard;
 
     VirtualPortal* virtual_portal;
 
@@ -40,6 +42,7 @@ typedef enum {
     PoFViewWidget,
     PoFViewPopup,
     PoFViewLoading,
+    PoFViewDashboard,
 } PoFView;
 
 void pof_start(PoFApp* app);
@@ -1,3 +1,6 @@
 ADD_SCENE(pof, main, Main)
 ADD_SCENE(pof, file_select, FileSelect)
 ADD_SCENE(pof, type_select, TypeSelect)
+ADD_SCENE(pof, stats, Stats)
+ADD_SCENE(pof, memory, Memory)
+ADD_SCENE(pof, debug, Debug)
@@ -0,0 +1,72 @@
+#include "../portal_of_flipper_i.h"
+#include "../helpers/pof_trace.h"
+
+enum SubmenuIndex {
+    SubmenuIndexStats,
+    SubmenuIndexMemory,
+    SubmenuIndexTrace,
+};
+
+void pof_scene_debug_submenu_callback(void* context, uint32_t index) {
+    PoFApp* pof = context;
+    view_dispatcher_send_custom_event(pof->view_dispatcher, index);
+}
+
+static const char* pof_scene_debug_trace_label(void) {
+    if(pof_trace_is_running()) {
+        return "USB trace: on";
+    }
+    return pof_trace_has_failed() ? "USB trace: failed" : "USB trace: off";
+}
+
+static void pof_scene_debug_update(PoFApp* pof) {
+    Submenu* submenu = pof->submenu;
+    submenu_reset(submenu);
+    submenu_add_item(
+        submenu, "Stats", SubmenuIndexStats, pof_scene_debug_submenu_callback, pof);
+    submenu_add_item(
+        submenu, "Memory", SubmenuIndexMemory, pof_scene_debug_submenu_callback, pof);
+    submenu_add_item(
+        submenu,
+        pof_scene_debug_trace_label(),
+        SubmenuIndexTrace,
+        pof_scene_debug_submenu_callback,
+        pof);
+    submenu_set_selected_item(
+        submenu, scene_manager_get_scene_state(pof->scene_manager, PoFSceneDebug));
+}
+
+void pof_scene_debug_on_enter(void* context) {
+    PoFApp* pof = context;
+    pof_scene_debug_update(pof);
+    view_dispatcher_switch_to_view(pof->view_dispatcher, PoFViewSubmenu);
+}
+
+bool pof_scene_debug_on_event(void* context, SceneManagerEvent event) {
+    PoFApp* pof = context;
+    bool consumed = false;
+
+    if(event.type == SceneManagerEventTypeCustom) {
+        scene_manager_set_scene_state(pof->scene_manager, PoFSceneDebug, event.event);
+        if(event.event == SubmenuIndexStats) {
+            scene_manager_next_scene(pof->scene_manager, PoFSceneStats);
+        } else if(event.event == SubmenuIndexMemory) {
+            scene_manager_next_scene(pof->scene_manager, PoFSceneMemory);
+        } else if(event.event == SubmenuIndexTrace) {
+            if(pof_trace_is_running()) {
+                pof_trace_stop();
+            } else {
+                pof_trace_start();
+            }
+            pof_scene_debug_update(pof);
+        }
+        consumed = true;
+    }
+
+    return consumed;
+}
+
+void pof_scene_debug_on_exit(void* context) {
+    PoFApp* pof = context;
+    submenu_reset(pof->submenu);
+}
@@ -1,60 +1,112 @@
 #include "../portal_of_flipper_i.h"
 #include "../pof_token.h"
 
-enum SubmenuIndex {
-    SubmenuIndexLoad = POF_TOKEN_LIMIT,
+enum PoFSceneMainEvent {
+    PoFSceneMainEventSelect,
+    PoFSceneMainEventMenu,
 };
 
-void pof_scene_main_submenu_callback(void* context, uint32_t index) {
+// Status responses counted over the last second
+static uint32_t pof_scene_main_status_count = 0;
+static uint32_t pof_scene_main_status_tick = 0;
+static uint16_t pof_scene_main_status_rate = 0;
+
+static void pof_scene_main_dashboard_callback(PoFDashboardEvent event, void* context) {
     PoFApp* pof = context;
-    view_dispatcher_send_custom_event(pof->view_dispatcher, index);
+    view_dispatcher_send_custom_event(
+        pof->view_dispatcher,
+        event == PoFDashboardEventMenu ? PoFSceneMainEventMenu : PoFSceneMainEventSelect);
+}
+
+static void pof_scene_main_status_rate_update(VirtualPortal* virtual_portal) {
+    uint32_t now = furi_get_tick();
+    uint32_t elapsed = now - pof_scene_main_status_tick;
+    if(elapsed < furi_ms_to_ticks(1000)) {
+        return;
+    }
+    uint32_t count = virtual_portal->status_count;
+    pof_scene_main_status_rate =
+        (count - pof_scene_main_status_count) * furi_ms_to_ticks(1000) / elapsed;
+    pof_scene_main_status_count = count;
+    pof_scene_main_status_tick = now;
+}
+
+static void pof_scene_main_led(const VirtualPortalLed* led, uint8_t* out) {
+    out[0] = led->r;
+    out[1] = led->g;
+    out[2] = led->b;
+}
+
+// Returns true when a checksum failed
+static bool pof_scene_main_figure(PoFToken* pof_token, char* name, PoFDashboardFigure* figure) {
+    PoFFigureInfo info;
+    pof_figure_get(&pof_token->figure, &info);
+    // The nickname given in game beats the file name
+    strlcpy(
+        name,
+        info.area_valid && info.nickname[0] ? info.nickname : pof_token->dev_name,
+        POF_DASHBOARD_NAME_LEN);
+    if(!info.valid) {
+        return false;
+    }
+    figure->type = info.type;
+    figure->character_id = info.character_id;
+    figure->variant = info.variant;
+    if(info.area_valid) {
+        figure->level = info.level;
+        figure->gold = info.gold;
+    }
+    return info.checks_failed != 0;
 }
 
+// Runs on the app thread at the dispatcher tick rate, reads the portal without locking.
+// A torn value only lasts until the next tick.
 void pof_scene_main_on_update(void* context) {
     PoFApp* pof = context;
     VirtualPortal* virtual_portal = pof->virtual_portal;
 
-    Submenu* submenu = pof->submenu;
-    submenu_reset(pof->submenu);
-    FuriString* token_name = furi_string_alloc();
-
-    if(pof->pof_usb) {
-        int count = 0;
+    PoFDashboardState state;
+    memset(&state, 0, sizeof(state));
+    state.started = pof->pof_usb != NULL;
+    if(state.started) {
+        state.active = virtual_portal->active;
+        state.speaker = virtual_portal->speaker;
         for(int i = 0; i < POF_TOKEN_LIMIT; i++) {
-            if(virtual_portal->tokens[i]->loaded) {
-                PoFToken* pof_token = virtual_portal->tokens[i];
-                furi_string_reset(token_name);
-                //TODO: only do if debug mode
-                furi_string_cat_printf(token_name, "%d: %s", i, pof_token->dev_name);
-
-                // Unload figure
-                submenu_add_item(
-                    submenu,
-                    furi_string_get_cstr(token_name),
-                    i,
-                    pof_scene_main_submenu_callback,
-                    pof);
-                count++;
+            PoFToken* pof_token = virtual_portal->tokens[i];
+            if(pof_token->loaded) {
+                state.slots[i] |= PoFDashboardSlotLoaded;
+                if(pof_scene_main_figure(pof_token, state.names[i], &state.figures[i])) {
+                    state.slots[i] |= PoFDashboardSlotBad;
+                }
             }
+            if(pof_token->change) state.slots[i] |= PoFDashboardSlotChange;
+            if(pof_token->dirty) state.slots[i] |= PoFDashboardSlotDirty;
+            if(pof_token->writing) state.slots[i] |= PoFDashboardSlotWriting;
         }
-
-        if(count < POF_TOKEN_LIMIT) {
-            submenu_add_item(
-                submenu, "<Load figure>", SubmenuIndexLoad, pof_scene_main_submenu_callback, pof);
+        pof_scene_main_led(&virtual_portal->left, state.leds[PoFDashboardLedLeft]);
+        pof_scene_main_led(&virtual_portal->right, state.leds[PoFDashboardLedRight]);
+        pof_scene_main_led(&virtual_portal->trap, state.leds[PoFDashboardLedTrap]);
+        pof_scene_main_status_rate_update(virtual_portal);
+        state.status_rate = pof_scene_main_status_rate;
+        if(state.speaker) {
+            state.audio_fill = virtual_portal->count * 100 / SAMPLES_COUNT_BUFFERED;
         }
-
-        submenu_set_selected_item(
-            submenu, scene_manager_get_scene_state(pof->scene_manager, PoFSceneMain));
-    } else {
-        submenu_add_item(
-            submenu, "Failed to start", SubmenuIndexLoad, pof_scene_main_submenu_callback, pof);
+        state.audio_underruns = virtual_portal->audio_underruns;
     }
-    furi_string_free(token_name);
-    view_dispatcher_switch_to_view(pof->view_dispatcher, PoFViewSubmenu);
+    pof_dashboard_update(pof->dashboard, &state);
 }
 
 void pof_scene_main_on_enter(void* context) {
+    PoFApp* pof = context;
+    pof_scene_main_status_count = pof->virtual_portal->status_count;
+    pof_scene_main_status_tick = furi_get_tick();
+    pof_scene_main_status_rate = 0;
+
+    pof_dashboard_set_callback(pof->dashboard, pof_scene_main_dashboard_callback, pof);
+    pof_dashboard_set_slot(
+        pof->dashboard, scene_manager_get_scene_state(pof->scene_manager, PoFSceneMain));
     pof_scene_main_on_update(context);
+    view_dispatcher_switch_to_view(pof->view_dispatcher, PoFViewDashboard);
 }
 
 bool pof_scene_main_on_event(void* context, SceneManagerEvent event) {
@@ -63,19 +115,23 @@ bool pof_scene_main_on_event(void* context, SceneManagerEvent event) {
     bool consumed = false;
 
     if(event.type == SceneManagerEventTypeCustom) {
-        if(event.event == SubmenuIndexLoad) {
-            if(pof->pof_usb) {
-                // Explicitly save state so that the correct item is
-                // reselected if the user cancels loading a file.
-                scene_manager_set_scene_state(pof->scene_manager, PoFSceneMain, SubmenuIndexLoad);
+        uint8_t slot = pof_dashboard_get_slot(pof->dashboard);
+        // Explicitly save the slot so that it is reselected when coming back
+        scene_manager_set_scene_state(pof->scene_manager, PoFSceneMain, slot);
+        if(event.event == PoFSceneMainEventMenu) {
+            scene_manager_next_scene(pof->scene_manager, PoFSceneDebug);
+        } else if(pof->pof_usb) {
+            if(virtual_portal->tokens[slot]->loaded) {
+                virtual_portal_unload_token(virtual_portal, slot);
+                pof_scene_main_on_update(context);
+            } else {
                 scene_manager_next_scene(pof->scene_manager, PoFSceneFileSelect);
             }
-            consumed = true;
-        } else {
-            scene_manager_set_scene_state(pof->scene_manager, PoFSceneMain, event.event);
-            pof_token_clear(virtual_portal->tokens[event.event], true);
-            pof_scene_main_on_update(context);
         }
+        consumed = true;
+    } else if(event.type == SceneManagerEventTypeTick) {
+        pof_scene_main_on_update(context);
+        consumed = true;
     } else if(event.type == SceneManagerEventTypeBack) {
         scene_manager_stop(pof->scene_manager);
         view_dispatcher_stop(pof->view_dispatcher);
@@ -87,5 +143,5 @@ bool pof_scene_main_on_event(void* context, SceneManagerEvent event) {
 
 void pof_scene_main_on_exit(void* context) {
     PoFApp* pof = context;
-    submenu_reset(pof->submenu);
+    pof_dashboard_set_callback(pof->dashboard, NULL, NULL);
 }
@@ -0,0 +1,57 @@
+#include "../portal_of_flipper_i.h"
+#include "../helpers/pof_image.h"
+#include "../helpers/pof_mem.h"
+
+#define TAG "PoFSceneMemory"
+
+enum PoFSceneMemoryEvent {
+    PoFSceneMemoryEventRefresh,
+};
+
+static void
+    pof_scene_memory_button_callback(GuiButtonType result, InputType type, void* context) {
+    PoFApp* pof = context;
+    if(type == InputTypeShort && result == GuiButtonTypeCenter) {
+        view_dispatcher_send_custom_event(pof->view_dispatcher, PoFSceneMemoryEventRefresh);
+    }
+}
+
+static void pof_scene_memory_update(PoFApp* pof) {
+    Widget* widget = pof->widget;
+    widget_reset(widget);
+
+    pof_mem_sample();
+    FuriString* text = furi_string_alloc();
+    pof_mem_format(text);
+    pof_image_format(text);
+    widget_add_text_scroll_element(widget, 0, 0, 128, 52, furi_string_get_cstr(text));
+    furi_string_free(text);
+
+    widget_add_button_element(
+        widget, GuiButtonTypeCenter, "Refresh", pof_scene_memory_button_callback, pof);
+}
+
+void pof_scene_memory_on_enter(void* context) {
+    PoFApp* pof = context;
+    pof_scene_memory_update(pof);
+    view_dispatcher_switch_to_view(pof->view_dispatcher, PoFViewWidget);
+}
+
+bool pof_scene_memory_on_event(void* context, SceneManagerEvent event) {
+    PoFApp* pof = context;
+    bool consumed = false;
+
+    if(event.type == SceneManagerEventTypeCustom) {
+        if(event.event == PoFSceneMemoryEventRefresh) {
+            pof_scene_memory_update(pof);
+        }
+        consumed = true;
+    }
+
+    return consumed;
+}
+
+void pof_scene_memory_on_exit(void* context) {
+    PoFApp* pof = context;
+    widget_reset(pof->widget);
+}
@@ -0,0 +1,88 @@
+#include "../portal_of_flipper_i.h"
+#include "../helpers/pof_probe.h"
+
+#define TAG "PoFSceneStats"
+
+enum PoFSceneStatsEvent {
+    PoFSceneStatsEventReset,
+    PoFSceneStatsEventSave,
+};
+
+static void pof_scene_stats_button_callback(GuiButtonType result, InputType type, void* context) {
+    PoFApp* pof = context;
+    if(type != InputTypeShort) {
+        return;
+    }
+    if(result == GuiButtonTypeLeft) {
+        view_dispatcher_send_custom_event(pof->view_dispatcher, PoFSceneStatsEventReset);
+    } else if(result == GuiButtonTypeRight) {
+        view_dispatcher_send_custom_event(pof->view_dispatcher, PoFSceneStatsEventSave);
+    }
+}
+
+static void pof_scene_stats_checksums(PoFApp* pof, FuriString* text) {
+    for(int i = 0; i < POF_TOKEN_LIMIT; i++) {
+        PoFToken* pof_token = pof->virtual_portal->tokens[i];
+        if(!pof_token->loaded) {
+            continue;
+        }
+        PoFFigureInfo info;
+        pof_figure_get(&pof_token->figure, &info);
+        if(info.checks_failed) {
+            furi_string_cat_printf(text, "slot %d bad: ", i);
+            FuriString* failed = furi_string_alloc();
+            pof_figure_checks_format(failed, info.checks_failed);
+            furi_string_cat_printf(text, "%s\n", furi_string_get_cstr(failed));
+            furi_string_free(failed);
+        }
+    }
+}
+
+static void pof_scene_stats_update(PoFApp* pof, const char* footer) {
+    Widget* widget = pof->widget;
+    widget_reset(widget);
+
+    FuriString* text = furi_string_alloc();
+    furi_string_cat_printf(text, "us: min/mean/max\n");
+    pof_probe_format(text);
+    pof_scene_stats_checksums(pof, text);
+    if(footer) {
+        furi_string_cat_printf(text, "%s\n", footer);
+    }
+    widget_add_text_scroll_element(widget, 0, 0, 128, 52, furi_string_get_cstr(text));
+    furi_string_free(text);
+
+    widget_add_button_element(
+        widget, GuiButtonTypeLeft, "Reset", pof_scene_stats_button_callback, pof);
+    widget_add_button_element(
+        widget, GuiButtonTypeRight, "Save", pof_scene_stats_button_callback, pof);
+}
+
+void pof_scene_stats_on_enter(void* context) {
+    PoFApp* pof = context;
+    pof_scene_stats_update(pof, NULL);
+    view_dispatcher_switch_to_view(pof->view_dispatcher, PoFViewWidget);
+}
+
+bool pof_scene_stats_on_event(void* context, SceneManagerEvent event) {
+    PoFApp* pof = context;
+    bool consumed = false;
+
+    if(event.type == SceneManagerEventTypeCustom) {
+        if(event.event == PoFSceneStatsEventReset) {
+            pof_probe_reset();
+            pof_scene_stats_update(pof, NULL);
+        } else if(event.event == PoFSceneStatsEventSave) {
+            bool saved = pof_probe_save(POF_PROBE_PATH);
+            pof_scene_stats_update(pof, saved ? "Saved to SD" : "Save failed");
+        }
+        consumed = true;
+    }
+
+    return consumed;
+}
+
+void pof_scene_stats_on_exit(void* context) {
+    PoFApp* pof = context;
+    widget_reset(pof->widget);
+}
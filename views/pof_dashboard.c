@@ -0,0 +1,228 @@
+#include "pof_dashboard.h"
+
+#define POF_DASHBOARD_CELL_WIDTH 8
+#define POF_DASHBOARD_CELL_Y 2
+
+struct PoFDashboard {
+    View* view;
+    PoFDashboardCallback callback;
+    void* context;
+};
+
+typedef struct {
+    PoFDashboardState state;
+    uint8_t slot;
+} PoFDashboardModel;
+
+static void pof_dashboard_draw_slot(Canvas* canvas, uint8_t index, uint8_t slot, bool selected) {
+    int32_t x = index * POF_DASHBOARD_CELL_WIDTH + 1;
+    int32_t y = POF_DASHBOARD_CELL_Y;
+    if(slot & PoFDashboardSlotLoaded) {
+        canvas_draw_box(canvas, x, y, 6, 7);
+        canvas_set_color(canvas, ColorWhite);
+        if(slot & PoFDashboardSlotBad) {
+            canvas_draw_line(canvas, x + 1, y + 1, x + 4, y + 5);
+            canvas_draw_line(canvas, x + 4, y + 1, x + 1, y + 5);
+        } else if(slot & PoFDashboardSlotDirty) {
+            canvas_draw_box(canvas, x + 2, y + 2, 2, 3);
+        }
+        canvas_set_color(canvas, ColorBlack);
+    } else {
+        canvas_draw_frame(canvas, x, y, 6, 7);
+    }
+    // Above the cell: a bar while saving, a dot while the change is waiting for a status
+    if(slot & PoFDashboardSlotWriting) {
+        canvas_draw_line(canvas, x, 0, x + 5, 0);
+    } else if(slot & PoFDashboardSlotChange) {
+        canvas_draw_line(canvas, x + 2, 0, x + 3, 0);
+    }
+    if(selected) {
+        canvas_draw_box(canvas, x, y + 8, 6, 2);
+    }
+}
+
+static void pof_dashboard_draw_callback(Canvas* canvas, void* _model) {
+    PoFDashboardModel* model = _model;
+    PoFDashboardState* state = &model->state;
+    char line[32];
+
+    canvas_clear(canvas);
+    canvas_set_color(canvas, ColorBlack);
+    canvas_set_font(canvas, FontSecondary);
+
+    if(!state->started) {
+        canvas_draw_str_aligned(canvas, 64, 32, AlignCenter, AlignCenter, "Failed to start");
+        return;
+    }
+
+    for(uint8_t i = 0; i < POF_TOKEN_LIMIT; i++) {
+        pof_dashboard_draw_slot(canvas, i, state->slots[i], i == model->slot);
+    }
+
+    uint8_t slot = state->slots[model->slot];
+    if(slot & PoFDashboardSlotLoaded) {
+        snprintf(
+            line,
+            sizeof(line),
+            "%02u%s%s",
+            model->slot,
+            slot & PoFDashboardSlotBad ? " BAD " : " ",
+            state->names[model->slot]);
+    } else {
+        snprintf(line, sizeof(line), "%02u <empty>", model->slot);
+    }
+    canvas_draw_str(canvas, 0, 22, line);
+
+    const PoFDashboardFigure* figure = &state->figures[model->slot];
+    if(figure->type != PoFFigureTypeUnknown) {
+        int length = snprintf(
+            line,
+            sizeof(line),
+            "%s #%u",
+            pof_figure_type_name(figure->type),
+            figure->character_id);
+        if(figure->variant) {
+            length += snprintf(line + length, sizeof(line) - length, "/%u", figure->variant);
+        }
+        if(figure->level) {
+            snprintf(
+                line + length,
+                sizeof(line) - length,
+                " Lv%u %ug",
+                figure->level,
+                figure->gold);
+        }
+        canvas_draw_str(canvas, 0, 32, line);
+    }
+
+    snprintf(
+        line,
+        sizeof(line),
+        "Portal %s  Speaker %s",
+        state->active ? "on" : "off",
+        state->speaker ? "on" : "off");
+    canvas_draw_str(canvas, 0, 42, line);
+
+    uint8_t(*leds)[3] = state->leds;
+    snprintf(
+        line,
+        sizeof(line),
+        "L%02X%02X%02X R%02X%02X%02X T%02X%02X%02X",
+        leds[PoFDashboardLedLeft][0],
+        leds[PoFDashboardLedLeft][1],
+        leds[PoFDashboardLedLeft][2],
+        leds[PoFDashboardLedRight][0],
+        leds[PoFDashboardLedRight][1],
+        leds[PoFDashboardLedRight][2],
+        leds[PoFDashboardLedTrap][0],
+        leds[PoFDashboardLedTrap][1],
+        leds[PoFDashboardLedTrap][2]);
+    canvas_draw_str(canvas, 0, 52, line);
+
+    snprintf(
+        line,
+        sizeof(line),
+        "S %u/s  buf %u%%  ur %lu",
+        state->status_rate,
+        state->audio_fill,
+        state->audio_underruns);
+    canvas_draw_str(canvas, 0, 62, line);
+}
+
+static bool pof_dashboard_input_callback(InputEvent* event, void* context) {
+    PoFDashboard* dashboard = context;
+    bool consumed = false;
+
+    if(event->key == InputKeyLeft || event->key == InputKeyRight) {
+        if(event->type == InputTypeShort || event->type == InputTypeRepeat) {
+            int8_t step = event->key == InputKeyLeft ? POF_TOKEN_LIMIT - 1 : 1;
+            with_view_model(
+                dashboard->view,
+                PoFDashboardModel * model,
+                { model->slot = (model->slot + step) % POF_TOKEN_LIMIT; },
+                true);
+        }
+        consumed = true;
+    } else if(event->key == InputKeyOk) {
+        if(dashboard->callback) {
+            if(event->type == InputTypeShort) {
+                dashboard->callback(PoFDashboardEventSelect, dashboard->context);
+            } else if(event->type == InputTypeLong) {
+                dashboard->callback(PoFDashboardEventMenu, dashboard->context);
+            }
+        }
+        consumed = true;
+    }
+
+    return consumed;
+}
+
+PoFDashboard* pof_dashboard_alloc(void) {
+    PoFDashboard* dashboard = malloc(sizeof(PoFDashboard));
+    dashboard->callback = NULL;
+    dashboard->context = NULL;
+    dashboard->view = view_alloc();
+    view_allocate_model(dashboard->view, ViewModelTypeLocking, sizeof(PoFDashboardModel));
+    view_set_context(dashboard->view, dashboard);
+    view_set_draw_callback(dashboard->view, pof_dashboard_draw_callback);
+    view_set_input_callback(dashboard->view, pof_dashboard_input_callback);
+    with_view_model(
+        dashboard->view,
+        PoFDashboardModel * model,
+        { memset(model, 0, sizeof(PoFDashboardModel)); },
+        false);
+    return dashboard;
+}
+
+void pof_dashboard_free(PoFDashboard* dashboard) {
+    furi_assert(dashboard);
+    view_free(dashboard->view);
+    free(dashboard);
+}
+
+View* pof_dashboard_get_view(PoFDashboard* dashboard) {
+    furi_assert(dashboard);
+    return dashboard->view;
+}
+
+void pof_dashboard_set_callback(
+    PoFDashboard* dashboard,
+    PoFDashboardCallback callback,
+    void* context) {
+    furi_assert(dashboard);
+    dashboard->callback = callback;
+    dashboard->context = context;
+}
+
+bool pof_dashboard_update(PoFDashboard* dashboard, const PoFDashboardState* state) {
+    furi_assert(dashboard);
+    bool changed = false;
+    with_view_model(
+        dashboard->view,
+        PoFDashboardModel * model,
+        {
+            changed = memcmp(&model->state, state, sizeof(PoFDashboardState)) != 0;
+            if(changed) {
+                model->state = *state;
+            }
+        },
+        changed);
+    return changed;
+}
+
+uint8_t pof_dashboard_get_slot(PoFDashboard* dashboard) {
+    furi_assert(dashboard);
+    uint8_t slot = 0;
+    with_view_model(
+        dashboard->view, PoFDashboardModel * model, { slot = model->slot; }, false);
+    return slot;
+}
+
+void pof_dashboard_set_slot(PoFDashboard* dashboard, uint8_t slot) {
+    furi_assert(dashboard);
+    with_view_model(
+        dashboard->view,
+        PoFDashboardModel * model,
+        { model->slot = slot % POF_TOKEN_LIMIT; },
+        true);
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <gui/view.h>
+
+#include "../virtual_portal.h"
+#include "../helpers/pof_figure.h"
+
+#define POF_DASHBOARD_NAME_LEN 24
+
+typedef enum {
+    PoFDashboardSlotLoaded = (1 << 0),
+    PoFDashboardSlotChange = (1 << 1),
+    PoFDashboardSlotDirty = (1 << 2),
+    PoFDashboardSlotWriting = (1 << 3),
+    // A checksum didn't match the last time it was verified
+    PoFDashboardSlotBad = (1 << 4),
+} PoFDashboardSlot;
+
+// Decoded figure data for the selected slot line
+typedef struct {
+    PoFFigureType type;
+    uint16_t character_id;
+    uint16_t variant;
+    uint8_t level;
+    uint16_t gold;
+} PoFDashboardFigure;
+
+typedef enum {
+    PoFDashboardLedLeft,
+    PoFDashboardLedRight,
+    PoFDashboardLedTrap,
+
+    PoFDashboardLedCount,
+} PoFDashboardLed;
+
+/*
+ * Everything the dashboard shows. The owner fills one of these in from the portal
+ * and the view only redraws when it differs from what is already on screen.
+ */
+typedef struct {
+    bool started;
+    bool active;
+    bool speaker;
+    uint8_t slots[POF_TOKEN_LIMIT];
+    char names[POF_TOKEN_LIMIT][POF_DASHBOARD_NAME_LEN];
+    PoFDashboardFigure figures[POF_TOKEN_LIMIT];
+    uint8_t leds[PoFDashboardLedCount][3];
+    uint16_t status_rate;
+    uint8_t audio_fill;
+    uint32_t audio_underruns;
+} PoFDashboardState;
+
+typedef enum {
+    PoFDashboardEventSelect,
+    PoFDashboardEventMenu,
+} PoFDashboardEvent;
+
+// Called from the GUI thread
+typedef void (*PoFDashboardCallback)(PoFDashboardEvent event, void* context);
+
+typedef struct PoFDashboard PoFDashboard;
+
+PoFDashboard* pof_dashboard_alloc(void);
+void pof_dashboard_free(PoFDashboard* dashboard);
+View* pof_dashboard_get_view(PoFDashboard* dashboard);
+
+void pof_dashboard_set_callback(
+    PoFDashboard* dashboard,
+    PoFDashboardCallback callback,
+    void* context);
+
+// state should be zeroed before it is filled in, it is compared byte for byte.
+// Returns true when the view had to redraw.
+bool pof_dashboard_update(PoFDashboard* dashboard, const PoFDashboardState* state);
+
+uint8_t pof_dashboard_get_slot(PoFDashboard* dashboard);
+void pof_dashboard_set_slot(PoFDashboard* dashboard, uint8_t slot);
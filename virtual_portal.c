@@ -4,12 +4,17 @@
 #include <stm32wbxx_ll_dma.h>
 
 #include "audio/wav_player_hal.h"
+#include "helpers/pof_log.h"
+#include "helpers/pof_mem.h"
+#include "helpers/pof_probe.h"
 #include "string.h"
 
 #define TAG "VirtualPortal"
 
 #define BLOCK_SIZE 16
 
+#define VIRTUAL_PORTAL_LED_TICK 10
+
 #define PORTAL_SIDE_RING 0
 #define PORTAL_SIDE_RIGHT 0
 #define PORTAL_SIDE_TRAP 1
@@ -28,8 +33,28 @@ const NotificationSequence sequence_set_leds = {
     NULL,
 };
 
-static float lerp(float start, float end, float t) {
-    return start + (end - start) * t;
+// t is a fraction of 256
+static uint8_t led_lerp(uint8_t start, uint8_t end, uint32_t t) {
+    return start + ((int32_t)end - start) * (int32_t)t / 256;
+}
+
+static void wav_player_fill(VirtualPortal* virtual_portal, int start, int end) {
+    // Running dry part way through a half, either the host fell behind or a sound ended.
+    // An idle speaker doesn't count.
+    if (virtual_portal->count && virtual_portal->count < end - start) {
+        virtual_portal->audio_underruns++;
+    }
+    for (int i = start; i < end; i++) {
+        if (!virtual_portal->count) {
+            virtual_portal->audio_buffer[i] = 0;
+            continue;
+        }
+        virtual_portal->audio_buffer[i] = *virtual_portal->tail;
+        if (++virtual_portal->tail == virtual_portal->end) {
+            virtual_portal->tail = virtual_portal->current_audio_buffer;
+        }
+        virtual_portal->count--;
+    }
 }
 
 static void wav_player_dma_isr(void* ctx) {
@@ -37,83 +62,62 @@ static void wav_player_dma_isr(void* ctx) {
     // half of transfer
     if (LL_DMA_IsActiveFlag_HT1(DMA1)) {
         LL_DMA_ClearFlag_HT1(DMA1);
+        uint32_t probe_start = pof_probe_start();
         // fill first half of buffer
-        for (int i = 0; i < SAMPLES_COUNT / 2; i++) {
-            if (!virtual_portal->count) {
-                virtual_portal->audio_buffer[i] = 0;
-                continue;
-            }
-            virtual_portal->audio_buffer[i] = *virtual_portal->tail;
-            if (++virtual_portal->tail == virtual_portal->end) {
-                virtual_portal->tail = virtual_portal->current_audio_buffer;
-            }
-            virtual_portal->count--;
-        }
+        wav_player_fill(virtual_portal, 0, SAMPLES_COUNT / 2);
+        pof_probe_end(PoFProbeDmaIsr, probe_start);
     }
 
     // transfer complete
     if (LL_DMA_IsActiveFlag_TC1(DMA1)) {
         LL_DMA_ClearFlag_TC1(DMA1);
+        uint32_t probe_start = pof_probe_start();
         // fill second half of buffer
-        for (int i = SAMPLES_COUNT / 2; i < SAMPLES_COUNT; i++) {
-            if (!virtual_portal->count) {
-                virtual_portal->audio_buffer[i] = 0;
-                continue;
-            }
-            virtual_portal->audio_buffer[i] = *virtual_portal->tail;
-            if (++virtual_portal->tail == virtual_portal->end) {
-                virtual_portal->tail = virtual_portal->current_audio_buffer;
-            }
-            virtual_portal->count--;
-        }
+        wav_player_fill(virtual_portal, SAMPLES_COUNT / 2, SAMPLES_COUNT);
+        pof_probe_end(PoFProbeDmaIsr, probe_start);
     }
 }
 
-void virtual_portal_tick(void* ctx) {
-    VirtualPortal* virtual_portal = (VirtualPortal*)ctx;
-    (void)virtual_portal;
-    VirtualPortalLed* led = &virtual_portal->right;
+// Advance one transition, returns true when the light needs to be written out
+static bool virtual_portal_tick_led(VirtualPortalLed* led) {
     if (!led->running) {
-        return;
+        return false;
     }
     uint32_t elapsed = furi_get_tick() - led->start_time;
     if (elapsed < led->delay) {
-        float t_phase = fminf((float)elapsed / (float)led->delay, 1);
+        uint32_t t = (elapsed << 8) / led->delay;
 
         if (led->two_phase) {
             if (led->current_phase == 0) {
                 // Phase 1: Increase channels that need to go up, hold others constant
                 if (led->target_r > led->last_r) {
-                    led->r = lerp(led->last_r, led->target_r, t_phase);
+                    led->r = led_lerp(led->last_r, led->target_r, t);
                 }
                 if (led->target_g > led->last_g) {
-                    led->g = lerp(led->last_g, led->target_g, t_phase);
+                    led->g = led_lerp(led->last_g, led->target_g, t);
                 }
                 if (led->target_b > led->last_b) {
-                    led->b = lerp(led->last_b, led->target_b, t_phase);
+                    led->b = led_lerp(led->last_b, led->target_b, t);
                 }
             } else {
                 // Phase 2: Decrease channels that need to go down
                 if (led->target_r < led->last_r) {
-                    led->r = lerp(led->last_r, led->target_r, t_phase);
+                    led->r = led_lerp(led->last_r, led->target_r, t);
                 }
                 if (led->target_g < led->last_g) {
-                    led->g = lerp(led->last_g, led->target_g, t_phase);
+                    led->g = led_lerp(led->last_g, led->target_g, t);
                 }
                 if (led->target_b < led->last_b) {
-                    led->b = lerp(led->last_b, led->target_b, t_phase);
+                    led->b = led_lerp(led->last_b, led->target_b, t);
                 }
             }
         } else {
             // Simple one-phase transition: all channels change together
-            led->r = lerp(led->last_r, led->target_r, t_phase);
-            led->g = lerp(led->last_g, led->target_g, t_phase);
-            led->b = lerp(led->last_b, led->target_b, t_phase);
+            led->r = led_lerp(led->last_r, led->target_r, t);
+            led->g = led_lerp(led->last_g, led->target_g, t);
+            led->b = led_lerp(led->last_b, led->target_b, t);
         }
-
-        furi_hal_light_set(LightRed, led->r);
-        furi_hal_light_set(LightGreen, led->g);
-        furi_hal_light_set(LightBlue, led->b);
+        return true;
     } else if (led->two_phase && led->current_phase == 0) {
         // Move to phase 2 - save the current state as our "last" values for phase 2
         led->last_r = led->r;
@@ -121,32 +125,38 @@ void virtual_portal_tick(void* ctx) {
         led->last_b = led->b;
         led->start_time = furi_get_tick();
         led->current_phase++;
+        return false;
     } else {
         // Transition complete - set final values
         led->r = led->target_r;
         led->g = led->target_g;
         led->b = led->target_b;
-        furi_hal_light_set(LightRed, led->r);
-        furi_hal_light_set(LightGreen, led->g);
-        furi_hal_light_set(LightBlue, led->b);
         led->running = false;
+        return true;
     }
 }
 
-void queue_led_command(VirtualPortal* virtual_portal, int side, uint8_t r, uint8_t g, uint8_t b, uint16_t duration) {
-    VirtualPortalLed* led = &virtual_portal->left;
-    switch (side) {
-        case PORTAL_SIDE_RIGHT:
-            led = &virtual_portal->right;
-            break;
-        case PORTAL_SIDE_TRAP:
-            led = &virtual_portal->trap;
-            break;
-        case PORTAL_SIDE_LEFT:
-            led = &virtual_portal->left;
-            break;
+static void virtual_portal_set_light(Light light, uint8_t value, uint8_t* written) {
+    if (*written != value) {
+        furi_hal_light_set(light, value);
+        *written = value;
     }
+}
 
+// Left and right share the RGB LED, brightest channel wins. The trap light drives the backlight.
+static void virtual_portal_render_leds(VirtualPortal* virtual_portal) {
+    VirtualPortalLed* left = &virtual_portal->left;
+    VirtualPortalLed* right = &virtual_portal->right;
+    VirtualPortalLed* trap = &virtual_portal->trap;
+
+    virtual_portal_set_light(LightRed, MAX(left->r, right->r), &virtual_portal->light_r);
+    virtual_portal_set_light(LightGreen, MAX(left->g, right->g), &virtual_portal->light_g);
+    virtual_portal_set_light(LightBlue, MAX(left->b, right->b), &virtual_portal->light_b);
+    virtual_portal_set_light(
+        LightBacklight, MAX(trap->r, MAX(trap->g, trap->b)), &virtual_portal->light_backlight);
+}
+
+static void virtual_portal_start_led(VirtualPortalLed* led, uint8_t r, uint8_t g, uint8_t b, uint16_t duration) {
     // Store current values as last values
     led->last_r = led->r;
     led->last_g = led->g;
@@ -177,40 +187,152 @@ void queue_led_command(VirtualPortal* virtual_portal, int side, uint8_t r, uint8
         led->running = true;
     } else {
         // Immediate change, no transition
-        if (side == PORTAL_SIDE_RIGHT) {
-            led->r = r;
-            led->g = g;
-            led->b = b;
-            furi_hal_light_set(LightRed, r);
-            furi_hal_light_set(LightGreen, g);
-            furi_hal_light_set(LightBlue, b);
-        }
         led->running = false;
+        led->r = r;
+        led->g = g;
+        led->b = b;
+    }
+}
+
+static bool virtual_portal_led_pending(VirtualPortalLed* led) {
+    return __atomic_load_n(&led->command_seq, __ATOMIC_ACQUIRE) != led->applied_seq;
+}
+
+// Start the latest command if there is a new one, returns true when the light changed
+static bool virtual_portal_led_take_command(VirtualPortalLed* led) {
+    uint32_t seq = __atomic_load_n(&led->command_seq, __ATOMIC_ACQUIRE);
+    if (seq == led->applied_seq || (seq & 1)) {
+        return false;
+    }
+    uint8_t r = led->command_r;
+    uint8_t g = led->command_g;
+    uint8_t b = led->command_b;
+    uint16_t duration = led->command_duration;
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    if (__atomic_load_n(&led->command_seq, __ATOMIC_RELAXED) != seq) {
+        // Overwritten while reading, take the newer one next tick
+        return false;
+    }
+    led->applied_seq = seq;
+    virtual_portal_start_led(led, r, g, b, duration);
+    return true;
+}
+
+static bool virtual_portal_leds_busy(VirtualPortal* virtual_portal) {
+    return virtual_portal->left.running || virtual_portal->right.running ||
+           virtual_portal->trap.running || virtual_portal_led_pending(&virtual_portal->left) ||
+           virtual_portal_led_pending(&virtual_portal->right) ||
+           virtual_portal_led_pending(&virtual_portal->trap);
+}
+
+static void virtual_portal_wake_leds(VirtualPortal* virtual_portal) {
+    if (!__atomic_exchange_n(&virtual_portal->led_timer_active, true, __ATOMIC_ACQ_REL)) {
+        furi_timer_start(virtual_portal->led_timer, VIRTUAL_PORTAL_LED_TICK);
+    }
+}
+
+/*
+ * One-shot, re-armed while a fade or a command is left, so an idle portal has no timer
+ * running. Stopping would have to wait for the daemon, which runs this, so it never does.
+ */
+void virtual_portal_tick(void* ctx) {
+    VirtualPortal* virtual_portal = (VirtualPortal*)ctx;
+    VirtualPortalLed* leds[] = {&virtual_portal->left, &virtual_portal->right, &virtual_portal->trap};
+    bool changed = false;
+    for (size_t i = 0; i < COUNT_OF(leds); i++) {
+        changed |= virtual_portal_led_take_command(leds[i]);
+        changed |= virtual_portal_tick_led(leds[i]);
+    }
+    if (changed) {
+        virtual_portal_render_leds(virtual_portal);
+    }
+
+    if (virtual_portal_leds_busy(virtual_portal)) {
+        furi_timer_start(virtual_portal->led_timer, VIRTUAL_PORTAL_LED_TICK);
+        return;
+    }
+    __atomic_store_n(&virtual_portal->led_timer_active, false, __ATOMIC_SEQ_CST);
+    // A command queued just before the store saw the timer active and didn't start it
+    if (virtual_portal_leds_busy(virtual_portal)) {
+        virtual_portal_wake_leds(virtual_portal);
+    }
+}
+
+// Called from the USB thread. Only publishes the latest target for the side, the LED timer
+// starts the transition and writes the hardware at its own rate.
+void queue_led_command(VirtualPortal* virtual_portal, int side, uint8_t r, uint8_t g, uint8_t b, uint16_t duration) {
+    VirtualPortalLed* led = &virtual_portal->left;
+    switch (side) {
+        case PORTAL_SIDE_RIGHT:
+            led = &virtual_portal->right;
+            break;
+        case PORTAL_SIDE_TRAP:
+            led = &virtual_portal->trap;
+            break;
+        case PORTAL_SIDE_LEFT:
+            led = &virtual_portal->left;
+            break;
     }
+
+    // Odd sequence while the command is being written
+    uint32_t seq = led->command_seq;
+    __atomic_store_n(&led->command_seq, seq + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    led->command_r = r;
+    led->command_g = g;
+    led->command_b = b;
+    led->command_duration = duration;
+    __atomic_store_n(&led->command_seq, seq + 2, __ATOMIC_RELEASE);
+
+    virtual_portal_wake_leds(virtual_portal);
 }
 
 VirtualPortal* virtual_portal_alloc(NotificationApp* notifications) {
+    size_t heap = pof_mem_heap_begin();
     VirtualPortal* virtual_portal = malloc(sizeof(VirtualPortal));
+    pof_mem_heap_end(PoFMemPortal, heap);
+    pof_mem_heap_move(
+        PoFMemPortal,
+        PoFMemAudio,
+        sizeof(virtual_portal->audio_buffer) + sizeof(virtual_portal->current_audio_buffer));
     virtual_portal->notifications = notifications;
 
     notification_message(virtual_portal->notifications, &sequence_set_backlight);
     notification_message(virtual_portal->notifications, &sequence_set_leds);
 
+    heap = pof_mem_heap_begin();
+    pof_image_init();
     for (int i = 0; i < POF_TOKEN_LIMIT; i++) {
         virtual_portal->tokens[i] = pof_token_alloc();
     }
+    pof_mem_heap_end(PoFMemTokens, heap);
     virtual_portal->sequence_number = 0;
+    virtual_portal->status_count = 0;
+    virtual_portal->audio_underruns = 0;
     virtual_portal->active = false;
     virtual_portal->volume = 20.0f;
 
+    memset(&virtual_portal->left, 0, sizeof(VirtualPortalLed));
+    memset(&virtual_portal->right, 0, sizeof(VirtualPortalLed));
+    memset(&virtual_portal->trap, 0, sizeof(VirtualPortalLed));
+    // The backlight starts on, so the trap light does too
+    virtual_portal->trap.r = 0xFF;
+    virtual_portal->trap.g = 0xFF;
+    virtual_portal->trap.b = 0xFF;
+    virtual_portal->light_r = 0;
+    virtual_portal->light_g = 0;
+    virtual_portal->light_b = 0;
+    virtual_portal->light_backlight = 0xFF;
+    virtual_portal->led_timer_active = false;
+    virtual_portal->load_mutex = furi_mutex_alloc(FuriMutexTypeNormal);
+    virtual_portal->write_path = furi_string_alloc();
+
     virtual_portal->led_timer = furi_timer_alloc(virtual_portal_tick,
-                                                 FuriTimerTypePeriodic, virtual_portal);
+                                                 FuriTimerTypeOnce, virtual_portal);
     virtual_portal->head = virtual_portal->current_audio_buffer;
     virtual_portal->tail = virtual_portal->current_audio_buffer;
     virtual_portal->end = &virtual_portal->current_audio_buffer[SAMPLES_COUNT_BUFFERED];
 
-    furi_timer_start(virtual_portal->led_timer, 10);
-
     if (furi_hal_speaker_acquire(1000)) {
         wav_player_speaker_init(8000);
         wav_player_dma_init((uint32_t)virtual_portal->audio_buffer, SAMPLES_COUNT);
@@ -237,8 +359,11 @@ void virtual_portal_free(VirtualPortal* virtual_portal) {
         pof_token_free(virtual_portal->tokens[i]);
         virtual_portal->tokens[i] = NULL;
     }
+    pof_image_deinit();
     furi_timer_stop(virtual_portal->led_timer);
     furi_timer_free(virtual_portal->led_timer);
+    furi_mutex_free(virtual_portal->load_mutex);
+    furi_string_free(virtual_portal->write_path);
     if (furi_hal_speaker_is_mine()) {
         furi_hal_speaker_release();
         wav_player_speaker_stop();
@@ -248,20 +373,28 @@ void virtual_portal_free(VirtualPortal* virtual_portal) {
     furi_hal_interrupt_set_isr(FuriHalInterruptIdDma1Ch1, NULL, NULL);
 
     free(virtual_portal);
+    pof_mem_heap_release(PoFMemTokens);
+    pof_mem_heap_release(PoFMemPortal);
+    pof_mem_heap_release(PoFMemAudio);
 }
 
-void virtual_portal_set_leds(uint8_t r, uint8_t g, uint8_t b) {
-    furi_hal_light_set(LightRed, r);
-    furi_hal_light_set(LightGreen, g);
-    furi_hal_light_set(LightBlue, b);
-}
-void virtual_portal_set_backlight(uint8_t brightness) {
-    furi_hal_light_set(LightBacklight, brightness);
+static void virtual_portal_copy_token(PoFToken* target, PoFToken* pof_token) {
+    // TODO: make pof_token_copy()
+    // Same figure in another slot costs no more memory until one of them is written
+    pof_token_set_image_ref(target, pof_token->image);
+    pof_figure_load(&target->figure, pof_image_get_data(target->image));
+
+    target->change = pof_token->change;
+    target->dirty = false;
+    memcpy(target->dev_name, pof_token->dev_name, sizeof(pof_token->dev_name));
+    memcpy(target->UID, pof_token->UID, sizeof(pof_token->UID));
+
+    furi_string_set(target->load_path, pof_token->load_path);
+    // Last, the USB worker reads the image as soon as this is set
+    target->loaded = pof_token->loaded;
 }
 
-void virtual_portal_load_token(VirtualPortal* virtual_portal, PoFToken* pof_token) {
-    furi_assert(pof_token);
-    FURI_LOG_D(TAG, "virtual_portal_load_token");
+static void virtual_portal_load_token_locked(VirtualPortal* virtual_portal, PoFToken* pof_token) {
     PoFToken* target = NULL;
     uint8_t empty[4] = {0, 0, 0, 0};
 
@@ -309,16 +442,57 @@ void virtual_portal_load_token(VirtualPortal* virtual_portal, PoFToken* pof_toke
     }
     furi_assert(target);
 
-    // TODO: make pof_token_copy()
-    target->change = pof_token->change;
-    target->loaded = pof_token->loaded;
-    memcpy(target->dev_name, pof_token->dev_name, sizeof(pof_token->dev_name));
-    memcpy(target->UID, pof_token->UID, sizeof(pof_token->UID));
+    virtual_portal_copy_token(target, pof_token);
+}
 
-    furi_string_set(target->load_path, pof_token->load_path);
+void virtual_portal_load_token(VirtualPortal* virtual_portal, PoFToken* pof_token) {
+    furi_assert(pof_token);
+    FURI_LOG_D(TAG, "virtual_portal_load_token");
+    // The session restore loads figures from its own thread
+    furi_mutex_acquire(virtual_portal->load_mutex, FuriWaitForever);
+    virtual_portal_load_token_locked(virtual_portal, pof_token);
+    furi_mutex_release(virtual_portal->load_mutex);
+}
 
-    const NfcDeviceData* data = nfc_device_get_data(pof_token->nfc_device, NfcProtocolMfClassic);
-    nfc_device_set_data(target->nfc_device, NfcProtocolMfClassic, data);
+bool virtual_portal_restore_token(
+    VirtualPortal* virtual_portal,
+    uint8_t slot,
+    const uint8_t* uid,
+    PoFToken* pof_token) {
+    furi_assert(slot < POF_TOKEN_LIMIT);
+    PoFToken* target = virtual_portal->tokens[slot];
+    bool restored = false;
+    furi_mutex_acquire(virtual_portal->load_mutex, FuriWaitForever);
+    // Something was loaded while the restore was running, it keeps the slot
+    if (!target->loaded) {
+        memcpy(target->UID, uid, sizeof(target->UID));
+        if (pof_token) {
+            virtual_portal_copy_token(target, pof_token);
+        }
+        restored = true;
+    }
+    furi_mutex_release(virtual_portal->load_mutex);
+    return restored;
+}
+
+void virtual_portal_unload_token(VirtualPortal* virtual_portal, uint8_t slot) {
+    furi_assert(slot < POF_TOKEN_LIMIT);
+    PoFToken* pof_token = virtual_portal->tokens[slot];
+    FuriString* path = furi_string_alloc();
+    furi_mutex_acquire(virtual_portal->load_mutex, FuriWaitForever);
+    // Our own reference, so the save doesn't hold up the USB worker
+    PoFImage* image = pof_token->image ? pof_image_ref(pof_token->image) : NULL;
+    furi_string_set(path, pof_token->load_path);
+    pof_token_clear(pof_token, false);
+    furi_mutex_release(virtual_portal->load_mutex);
+
+    if (image) {
+        uint32_t probe_start = pof_probe_start();
+        pof_image_save(image, furi_string_get_cstr(path));
+        pof_probe_end(PoFProbeNfcSave, probe_start);
+        pof_image_release(image);
+    }
+    furi_string_free(path);
 }
 
 uint8_t virtual_portal_next_sequence(VirtualPortal* virtual_portal) {
@@ -362,6 +536,8 @@ int virtual_portal_reset(VirtualPortal* virtual_portal, uint8_t* message, uint8_
 
 int virtual_portal_status(VirtualPortal* virtual_portal, uint8_t* response) {
     response[0] = 'S';
+    // Slot bits are ORed in, and the caller may reuse the same frame
+    memset(response + 1, 0, 4);
 
     bool update = false;
     for (size_t i = 0; i < POF_TOKEN_LIMIT; i++) {
@@ -378,15 +554,11 @@ int virtual_portal_status(VirtualPortal* virtual_portal, uint8_t* response) {
     }
     response[5] = virtual_portal_next_sequence(virtual_portal);
     response[6] = 1;
+    virtual_portal->status_count++;
 
     // Let me know when a status that actually has a change is sent
     if (update) {
-        char display[33] = {0};
-        memset(display, 0, sizeof(display));
-        for (size_t i = 0; i < BLOCK_SIZE; i++) {
-            snprintf(display + (i * 2), sizeof(display), "%02x", response[i]);
-        }
-        FURI_LOG_I(TAG, "> S %s", display);
+        pof_log_command('S', 0, 0, response);
     }
 
     return 7;
@@ -450,11 +622,11 @@ int virtual_portal_l(VirtualPortal* virtual_portal, uint8_t* message) {
             break;
         case 1:
             brightness = message[2];
-            virtual_portal_set_backlight(brightness);
+            queue_led_command(virtual_portal, PORTAL_SIDE_TRAP, brightness, brightness, brightness, 0);
             break;
         case 3:
             brightness = 0xff;
-            virtual_portal_set_backlight(brightness);
+            queue_led_command(virtual_portal, PORTAL_SIDE_TRAP, brightness, brightness, brightness, 0);
             break;
     }
     return 0;
@@ -489,23 +661,25 @@ int virtual_portal_query(VirtualPortal* virtual_portal, uint8_t* message, uint8_
     int index = message[1];
     int blockNum = message[2];
     int arrayIndex = index & 0x0f;
-    FURI_LOG_I(TAG, "Query %d %d", arrayIndex, blockNum);
+    pof_log_command('Q', arrayIndex, blockNum, NULL);
 
     PoFToken* pof_token = virtual_portal->tokens[arrayIndex];
+    // The UI can unload the figure, and drop its image, at any time
+    furi_mutex_acquire(virtual_portal->load_mutex, FuriWaitForever);
     if (!pof_token->loaded) {
+        furi_mutex_release(virtual_portal->load_mutex);
         response[0] = 'Q';
         response[1] = 0x00 | arrayIndex;
         response[2] = blockNum;
         return 3;
     }
-    NfcDevice* nfc_device = pof_token->nfc_device;
-    const MfClassicData* data = nfc_device_get_data(nfc_device, NfcProtocolMfClassic);
-    const MfClassicBlock block = data->block[blockNum];
+    const MfClassicData* data = pof_image_get_data(pof_token->image);
+    memcpy(response + 3, data->block[blockNum].data, BLOCK_SIZE);
+    furi_mutex_release(virtual_portal->load_mutex);
 
     response[0] = 'Q';
     response[1] = 0x10 | arrayIndex;
     response[2] = blockNum;
-    memcpy(response + 3, block.data, BLOCK_SIZE);
     return 3 + BLOCK_SIZE;
 }
 
@@ -514,32 +688,33 @@ int virtual_portal_write(VirtualPortal* virtual_portal, uint8_t* message, uint8_
     int blockNum = message[2];
     int arrayIndex = index & 0x0f;
 
-    char display[33] = {0};
-    for (size_t i = 0; i < BLOCK_SIZE; i++) {
-        snprintf(display + (i * 2), sizeof(display), "%02x", message[3 + i]);
-    }
-    FURI_LOG_I(TAG, "Write %d %d %s", arrayIndex, blockNum, display);
+    pof_log_command('W', arrayIndex, blockNum, message + 3);
 
     PoFToken* pof_token = virtual_portal->tokens[arrayIndex];
+    furi_mutex_acquire(virtual_portal->load_mutex, FuriWaitForever);
     if (!pof_token->loaded) {
+        furi_mutex_release(virtual_portal->load_mutex);
         response[0] = 'W';
         response[1] = 0x00 | arrayIndex;
         response[2] = blockNum;
         return 3;
     }
 
-    NfcDevice* nfc_device = pof_token->nfc_device;
-
-    MfClassicData* data = mf_classic_alloc();
-    nfc_device_copy_data(nfc_device, NfcProtocolMfClassic, data);
-    MfClassicBlock* block = &data->block[blockNum];
+    const MfClassicData* data = pof_image_write(&pof_token->image, blockNum, message + 3);
+    pof_figure_write(&pof_token->figure, data, blockNum);
 
-    memcpy(block->data, message + 3, BLOCK_SIZE);
-    nfc_device_set_data(nfc_device, NfcProtocolMfClassic, data);
+    pof_token->dirty = true;
+    pof_token->writing = true;
+    // Saved outside the lock, the reference keeps the image alive if the figure is unloaded
+    PoFImage* image = pof_image_ref(pof_token->image);
+    furi_string_set(virtual_portal->write_path, pof_token->load_path);
+    furi_mutex_release(virtual_portal->load_mutex);
 
-    mf_classic_free(data);
-
-    nfc_device_save(nfc_device, furi_string_get_cstr(pof_token->load_path));
+    uint32_t probe_start = pof_probe_start();
+    pof_image_save(image, furi_string_get_cstr(virtual_portal->write_path));
+    pof_probe_end(PoFProbeNfcSave, probe_start);
+    pof_image_release(image);
+    pof_token->writing = false;
 
     response[0] = 'W';
     response[1] = 0x10 | arrayIndex;
@@ -547,11 +722,35 @@ int virtual_portal_write(VirtualPortal* virtual_portal, uint8_t* message, uint8_
     return 3;
 }
 
+uint32_t virtual_portal_verify(VirtualPortal* virtual_portal, uint32_t now) {
+    uint32_t wait = FuriWaitForever;
+    bool verified = false;
+    for (int i = 0; i < POF_TOKEN_LIMIT; i++) {
+        PoFToken* pof_token = virtual_portal->tokens[i];
+        furi_mutex_acquire(virtual_portal->load_mutex, FuriWaitForever);
+        if (!pof_token->loaded) {
+            furi_mutex_release(virtual_portal->load_mutex);
+            continue;
+        }
+        uint32_t token_wait = pof_figure_verify_wait(&pof_token->figure, now);
+        if (token_wait == 0 && !verified) {
+            const MfClassicData* data = pof_image_get_data(pof_token->image);
+            pof_figure_verify_step(&pof_token->figure, data);
+            verified = true;
+            token_wait = pof_figure_verify_wait(&pof_token->figure, now);
+        }
+        furi_mutex_release(virtual_portal->load_mutex);
+        wait = MIN(wait, token_wait);
+    }
+    return wait;
+}
+
 // HID portals use send 8000hz 16 bit signed PCM samples
 void virtual_portal_process_audio(
     VirtualPortal* virtual_portal,
     uint8_t* message,
     uint8_t len) {
+    uint32_t probe_start = pof_probe_start();
     for (size_t i = 0; i < len; i += 2) {
         int16_t int_16 =
             (((int16_t)message[i + 1] << 8) + ((int16_t)message[i]));
@@ -578,6 +777,7 @@ void virtual_portal_process_audio(
             virtual_portal->head = virtual_portal->current_audio_buffer;
         }
     }
+    pof_probe_end(PoFProbeAudio, probe_start);
 }
 
 // 360 portals didn't have the bandwith, so they use CCITT G.721 ADPCM coding
@@ -586,6 +786,7 @@ void virtual_portal_process_audio_360(
     VirtualPortal* virtual_portal,
     uint8_t* message,
     uint8_t len) {
+    uint32_t probe_start = pof_probe_start();
     for (size_t i = 0; i < len; i++) {
         int16_t int_16 = (int16_t)g721_decoder(message[i], &virtual_portal->state);
 
@@ -635,10 +836,11 @@ void virtual_portal_process_audio_360(
             virtual_portal->head = virtual_portal->current_audio_buffer;
         }
     }
+    pof_probe_end(PoFProbeAudio360, probe_start);
 }
 
 // 32 byte message, 32 byte response;
-int virtual_portal_process_message(
+static int virtual_portal_dispatch_message(
     VirtualPortal* virtual_portal,
     uint8_t* message,
     uint8_t* response) {
@@ -684,4 +886,14 @@ int virtual_portal_process_message(
     }
 
     return 0;
-}
\ No newline at end of file
+}
+
+int virtual_portal_process_message(
+    VirtualPortal* virtual_portal,
+    uint8_t* message,
+    uint8_t* response) {
+    uint32_t probe_start = pof_probe_start();
+    int send_len = virtual_portal_dispatch_message(virtual_portal, message, response);
+    pof_probe_end(pof_probe_message_id(message[0]), probe_start);
+    return send_len;
+}
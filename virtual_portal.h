@@ -24,11 +24,12 @@ typedef enum {
     EventTxComplete = (1 << 4),
     EventResetSio = (1 << 5),
     EventTxImmediate = (1 << 6),
+    EventMode = (1 << 7),
     WavPlayerEventHalfTransfer = (1 << 2),
     WavPlayerEventFullTransfer = (1 << 3),
 
     EventAll = EventExit | EventReset | EventRx | EventTx | EventTxComplete | EventResetSio |
-               EventTxImmediate,
+               EventTxImmediate | EventMode,
 } PoFEvent;
 
 typedef struct {
@@ -46,11 +47,22 @@ typedef struct {
     bool two_phase;
     bool running;
     int current_phase;
+    // Latest command for this side, written by the USB thread under command_seq
+    // (odd while writing) and started by the LED timer once applied_seq falls behind.
+    uint32_t command_seq;
+    uint32_t applied_seq;
+    uint8_t command_r;
+    uint8_t command_g;
+    uint8_t command_b;
+    uint16_t command_duration;
 } VirtualPortalLed;
 
 typedef struct {
     PoFToken* tokens[POF_TOKEN_LIMIT];
     uint8_t sequence_number;
+    // Counters for the dashboard, only ever incremented
+    uint32_t status_count;
+    uint32_t audio_underruns;
     float volume;
     bool playing_audio;
     uint8_t audio_buffer[SAMPLES_COUNT];
@@ -67,8 +79,19 @@ typedef struct {
     VirtualPortalLed left;
     VirtualPortalLed right;
     VirtualPortalLed trap;
+    // Last values written to the hardware
+    uint8_t light_r;
+    uint8_t light_g;
+    uint8_t light_b;
+    uint8_t light_backlight;
     FuriTimer* led_timer;
+    bool led_timer_active;
     FuriThread* thread;
+    // Held while a figure is put into or taken out of a slot, and by the USB worker
+    // while it uses the figure in a slot
+    FuriMutex* load_mutex;
+    // USB worker only, where the figure being written is saved to
+    FuriString* write_path;
     struct g72x_state state;
 } VirtualPortal;
 
@@ -78,6 +101,15 @@ void virtual_portal_set_type(VirtualPortal* virtual_portal, PoFType type);
 void virtual_portal_free(VirtualPortal* virtual_portal);
 void virtual_portal_cleanup(VirtualPortal* virtual_portal);
 void virtual_portal_load_token(VirtualPortal* virtual_portal, PoFToken* pof_token);
+// Puts the slot back the way it was last session: uid is its slot affinity and pof_token,
+// if not NULL, the figure that was in it. False if the slot was loaded meanwhile.
+bool virtual_portal_restore_token(
+    VirtualPortal* virtual_portal,
+    uint8_t slot,
+    const uint8_t* uid,
+    PoFToken* pof_token);
+// Saves the figure back to its file and empties the slot, from any thread but the USB worker
+void virtual_portal_unload_token(VirtualPortal* virtual_portal, uint8_t slot);
 void virtual_portal_tick();
 
 int virtual_portal_process_message(
@@ -90,3 +122,7 @@ void virtual_portal_process_audio_360(VirtualPortal* virtual_portal,
                                   uint8_t* message, uint8_t len);
 
 int virtual_portal_send_status(VirtualPortal* virtual_portal, uint8_t* response);
+
+// Checks one region of figure checksums that a write left pending. Call from the USB
+// worker, which writes the figure data. Returns ticks until more checks are due.
+uint32_t virtual_portal_verify(VirtualPortal* virtual_portal, uint32_t now);
@@ -2,9 +2,6 @@
 #include "excrypt_des_data.h"
 #include <string.h>
 
-#define LODWORD(_qw)    ((uint32_t)(_qw))
-#define HIDWORD(_qw)    ((uint32_t)(((_qw) >> 32) & 0xffffffff))
-
 // DES code based on https://github.com/fffaraz/cppDES
 
 void ExCryptDesParity(const uint8_t* input, uint32_t input_size, uint8_t* output)
@@ -23,9 +20,11 @@ void ExCryptDesParity(const uint8_t* input, uint32_t input_size, uint8_t* output
 
 void ExCryptDesKey(EXCRYPT_DES_STATE* state, const uint8_t* key)
 {
-  uint64_t qkey = SWAP64(*(const uint64_t*)key);
+  uint64_t qkey;
+  memcpy(&qkey, key, sizeof(qkey));
+  qkey = SWAP64(qkey);
 
-  // initial key schedule calculation
+  // initial key schedule calculation, only done once per key
   uint64_t permuted_choice_1 = 0; // 56 bits
   for (int i = 0; i < 56; i++)
   {
@@ -40,110 +39,96 @@ void ExCryptDesKey(EXCRYPT_DES_STATE* state, const uint8_t* key)
   // Calculation of the 16 keys
   for (int i = 0; i < 16; i++)
   {
-    // key schedule, shifting Ci and Di
-    for (int j = 0; j < ITERATION_SHIFT[i]; j++)
+    // key schedule, rotating Ci and Di
+    int shift = ITERATION_SHIFT[i];
+    C = (0x0fffffff & (C << shift)) | (C >> (28 - shift));
+    D = (0x0fffffff & (D << shift)) | (D >> (28 - shift));
+
+    // PC2 a nibble at a time, straight into one 6 bit chunk per S-box
+    uint32_t kc = 0;
+    uint32_t kd = 0;
+    for (int j = 0; j < 7; j++)
     {
-      C = (0x0fffffff & (C << 1)) | (0x00000001 & (C >> 27));
-      D = (0x0fffffff & (D << 1)) | (0x00000001 & (D >> 27));
+      kc |= PC2_C[j][(C >> (24 - 4 * j)) & 0x0f];
+      kd |= PC2_D[j][(D >> (24 - 4 * j)) & 0x0f];
     }
 
-    uint64_t permuted_choice_2 = (((uint64_t)C) << 28) | (uint64_t)D;
-
-    uint64_t sub_key = 0; // 48 bits (2*24)
-    for (int j = 0; j < 48; j++)
-    {
-      sub_key <<= 1;
-      sub_key |= (permuted_choice_2 >> (56 - PC2[j])) & LB64_MASK;
-    }
-    state->keytab[i] = sub_key;
+    uint8_t* sub_key = state->keytab[i];
+    sub_key[0] = (uint8_t)(kc >> 24);
+    sub_key[1] = (uint8_t)(kc >> 16);
+    sub_key[2] = (uint8_t)(kc >> 8);
+    sub_key[3] = (uint8_t)kc;
+    sub_key[4] = (uint8_t)(kd >> 24);
+    sub_key[5] = (uint8_t)(kd >> 16);
+    sub_key[6] = (uint8_t)(kd >> 8);
+    sub_key[7] = (uint8_t)kd;
   }
 }
 
-uint32_t f(uint32_t R, uint64_t k)
+static inline uint32_t f(uint32_t R, const uint8_t* k)
 {
-  // applying expansion permutation and returning 48-bit data
-  uint64_t s_input = 0;
-  for (int i = 0; i < 48; i++)
-  {
-    s_input <<= 1;
-    s_input |= (uint64_t)((R >> (32 - EXPANSION[i])) & LB32_MASK);
-  }
-
-  // XORing expanded Ri with Ki, the round key
-  s_input = s_input ^ k;
-
-  // applying S-Boxes function and returning 32-bit data
-  uint32_t s_output = 0;
-  for (int i = 0; i < 8; i++)
-  {
-    // Outer bits
-    char row = (char)((s_input & (0x0000840000000000 >> 6 * i)) >> (42 - 6 * i));
-    row = (row >> 4) | (row & 0x01);
-
-    // Middle 4 bits of input
-    char column = (char)((s_input & (0x0000780000000000 >> 6 * i)) >> (43 - 6 * i));
-
-    s_output <<= 4;
-    s_output |= (uint32_t)(SBOX[i][16 * row + column] & 0x0f);
-  }
-
-  // applying the round permutation
-  uint32_t f_result = 0;
-  for (int i = 0; i < 32; i++)
-  {
-    f_result <<= 1;
-    f_result |= (s_output >> (32 - PBOX[i])) & LB32_MASK;
-  }
-
-  return f_result;
+  // The expansion takes 6 bit windows of R, each starting one bit before its nibble.
+  // Rotating right by one lines the first seven up on a shift, the last wraps around.
+  uint32_t r = (R >> 1) | (R << 31);
+  return SPBOX[0][((r >> 26) ^ k[0]) & 0x3f] ^
+         SPBOX[1][((r >> 22) ^ k[1]) & 0x3f] ^
+         SPBOX[2][((r >> 18) ^ k[2]) & 0x3f] ^
+         SPBOX[3][((r >> 14) ^ k[3]) & 0x3f] ^
+         SPBOX[4][((r >> 10) ^ k[4]) & 0x3f] ^
+         SPBOX[5][((r >> 6) ^ k[5]) & 0x3f] ^
+         SPBOX[6][((r >> 2) ^ k[6]) & 0x3f] ^
+         SPBOX[7][(((R << 1) | (R >> 31)) ^ k[7]) & 0x3f];
 }
 
-void feistel(uint32_t* L, uint32_t* R, uint32_t F)
-{
-  uint32_t temp = *R;
-  *R = *L ^ F;
-  *L = temp;
-}
+// Swap the bits selected by mask in a with the bits n places lower in b
+#define DES_SWAP_MOVE(a, b, n, mask) \
+  do { uint32_t _t = (((a) >> (n)) ^ (b)) & (mask); (b) ^= _t; (a) ^= _t << (n); } while (0)
 
 void ExCryptDesEcb(const EXCRYPT_DES_STATE* state, const uint8_t* input, uint8_t* output, uint8_t encrypt)
 {
-  uint64_t block;
-  memcpy(&block, input, sizeof(uint64_t));
-  block = SWAP64(block);
-  //uint64_t block = SWAP64(*(uint64_t*)input)
+  uint32_t L = ((uint32_t)input[0] << 24) | ((uint32_t)input[1] << 16) | ((uint32_t)input[2] << 8) | input[3];
+  uint32_t R = ((uint32_t)input[4] << 24) | ((uint32_t)input[5] << 16) | ((uint32_t)input[6] << 8) | input[7];
 
+  // initial permutation, as a handful of bit matrix transposes
+  DES_SWAP_MOVE(L, R, 4, 0x0f0f0f0f);
+  DES_SWAP_MOVE(L, R, 16, 0x0000ffff);
+  DES_SWAP_MOVE(R, L, 2, 0x33333333);
+  DES_SWAP_MOVE(R, L, 8, 0x00ff00ff);
+  DES_SWAP_MOVE(L, R, 1, 0x55555555);
 
-  // initial permutation
-  uint64_t result = 0;
-  for (int i = 0; i < 64; i++)
+  // 16 rounds, two per iteration so L and R never have to be swapped
+  if (encrypt)
   {
-    result <<= 1;
-    result |= (block >> (64 - IP[i])) & LB64_MASK;
+    for (int i = 0; i < 16; i += 2)
+    {
+      L ^= f(R, state->keytab[i]);
+      R ^= f(L, state->keytab[i + 1]);
+    }
   }
-
-  // dividing T' into two 32-bit parts
-  uint32_t L = HIDWORD(result);
-  uint32_t R = LODWORD(result);
-
-  // 16 rounds
-  for (int i = 0; i < 16; i++)
+  else
   {
-    uint32_t F = !encrypt ? f(R, state->keytab[15 - i]) : f(R, state->keytab[i]);
-    feistel(&L, &R, F);
+    for (int i = 15; i > 0; i -= 2)
+    {
+      L ^= f(R, state->keytab[i]);
+      R ^= f(L, state->keytab[i - 1]);
+    }
   }
 
-  // swapping the two parts
-  block = (((uint64_t)R) << 32) | (uint64_t)L;
-
-  // inverse initial permutation
-  result = 0;
-  for (int i = 0; i < 64; i++)
-  {
-    result <<= 1;
-    result |= (block >> (64 - FP[i])) & LB64_MASK;
-  }
-  result = SWAP64(result);
-  memcpy(output, &result, sizeof(result));
+  // inverse initial permutation, with the final swap of the two halves
+  DES_SWAP_MOVE(R, L, 1, 0x55555555);
+  DES_SWAP_MOVE(L, R, 8, 0x00ff00ff);
+  DES_SWAP_MOVE(L, R, 2, 0x33333333);
+  DES_SWAP_MOVE(R, L, 16, 0x0000ffff);
+  DES_SWAP_MOVE(R, L, 4, 0x0f0f0f0f);
+
+  output[0] = (uint8_t)(R >> 24);
+  output[1] = (uint8_t)(R >> 16);
+  output[2] = (uint8_t)(R >> 8);
+  output[3] = (uint8_t)R;
+  output[4] = (uint8_t)(L >> 24);
+  output[5] = (uint8_t)(L >> 16);
+  output[6] = (uint8_t)(L >> 8);
+  output[7] = (uint8_t)L;
 }
 
 void ExCryptDes3Key(EXCRYPT_DES3_STATE* state, const uint64_t* keys)
@@ -4,7 +4,8 @@
 
 typedef struct _EXCRYPT_DES_STATE
 {
-  uint64_t keytab[16];
+  // 6 bit subkey chunk for each S-box, per round
+  uint8_t keytab[16][8];
 } EXCRYPT_DES_STATE;
 
 void ExCryptDesParity(const uint8_t* input, uint32_t input_size, uint8_t* output);
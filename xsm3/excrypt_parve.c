@@ -3,78 +3,107 @@
 
 #include "excrypt.h"
 
-void ExCryptParveEcb(const uint8_t* key, const uint8_t* sbox, const uint8_t* input, uint8_t* output)
+// 2^31 - 1, the modulus ChainAndSum works in
+#define PARVE_M31 0x7FFFFFFF
+
+// x % (2^31 - 1) without a 64 bit division, folding the high bits back in since 2^31 = 1
+static inline uint32_t parve_mod_m31(uint64_t x)
 {
-  uint8_t block[9];
+  x = (x & PARVE_M31) + (x >> 31);
+  x = (x & PARVE_M31) + (x >> 31);
+  uint32_t r = (uint32_t)x;
+  return r >= PARVE_M31 ? r - PARVE_M31 : r;
+}
 
-  memcpy(block, input, 8);
-  block[8] = block[0];
+// ki is the key byte plus the round number, worked out before the dependent chain
+#define PARVE_STEP(ki, prev, cur) \
+  cur = sbox[(uint8_t)((prev) + (ki))] + (cur); \
+  cur = ROTL8(cur, 1)
 
-  for (int i = 8; i > 0; i--)
+// The 9th byte of the original block buffer is always a copy of the first one,
+// so each round writes its last step straight back into b0.
+static void parve_block(const uint8_t* key, const uint8_t* sbox, uint8_t* block)
+{
+  uint8_t b0 = block[0], b1 = block[1], b2 = block[2], b3 = block[3];
+  uint8_t b4 = block[4], b5 = block[5], b6 = block[6], b7 = block[7];
+
+  for (uint8_t i = 8; i > 0; i--)
   {
-    for (int j = 0; j < 8; j++)
-    {
-      uint8_t x = key[j] + block[j] + i;
-      uint8_t y = sbox[x] + block[j + 1];
-      block[j + 1] = ROTL8(y, 1);
-    }
-
-    block[0] = block[8];
+    PARVE_STEP(key[0] + i, b0, b1);
+    PARVE_STEP(key[1] + i, b1, b2);
+    PARVE_STEP(key[2] + i, b2, b3);
+    PARVE_STEP(key[3] + i, b3, b4);
+    PARVE_STEP(key[4] + i, b4, b5);
+    PARVE_STEP(key[5] + i, b5, b6);
+    PARVE_STEP(key[6] + i, b6, b7);
+    PARVE_STEP(key[7] + i, b7, b0);
   }
 
+  block[0] = b0;
+  block[1] = b1;
+  block[2] = b2;
+  block[3] = b3;
+  block[4] = b4;
+  block[5] = b5;
+  block[6] = b6;
+  block[7] = b7;
+}
+
+void ExCryptParveEcb(const uint8_t* key, const uint8_t* sbox, const uint8_t* input, uint8_t* output)
+{
+  uint8_t block[8];
+
+  memcpy(block, input, 8);
+  parve_block(key, sbox, block);
   memcpy(output, block, 8);
 }
 
 void ExCryptParveCbcMac(const uint8_t* key, const uint8_t* sbox, const uint8_t* iv, const uint8_t* input, uint32_t input_size, uint8_t* output)
 {
-  uint64_t block;
-  uint64_t temp;
-  memcpy(&block, iv, 8);
+  uint32_t block[2];
+  uint32_t temp[2];
+  memcpy(block, iv, 8);
 
-  if (input_size >= 8)
+  for (uint32_t i = 0; i < input_size / 8; i++)
   {
-    for (uint32_t i = 0; i < input_size / 8; i++)
-    {
-      memcpy(&temp, input + (i * 8), sizeof(temp));
-      block ^= temp;
-      ExCryptParveEcb(key, sbox, (uint8_t*)&block, (uint8_t*)&block);
-    }
+    memcpy(temp, input + (i * 8), sizeof(temp));
+    block[0] ^= temp[0];
+    block[1] ^= temp[1];
+    parve_block(key, sbox, (uint8_t*)block);
   }
 
-  memcpy(output, &block, 8);
+  memcpy(output, block, 8);
 }
 
 void ExCryptChainAndSumMac(const uint32_t* cd, const uint32_t* ab, const uint32_t* input, uint32_t input_dwords, uint32_t* output)
 {
-  uint64_t out0 = 0;
+  uint32_t out0 = 0;
   uint64_t out1 = 0;
 
-  uint32_t ab0 = SWAP32(ab[0]) % 0x7FFFFFFF;
-  uint32_t ab1 = SWAP32(ab[1]) % 0x7FFFFFFF;
-  uint32_t cd0 = SWAP32(cd[0]) % 0x7FFFFFFF;
-  uint32_t cd1 = SWAP32(cd[1]) % 0x7FFFFFFF;
+  uint32_t ab0 = parve_mod_m31(SWAP32(ab[0]));
+  uint32_t ab1 = parve_mod_m31(SWAP32(ab[1]));
+  uint32_t cd0 = parve_mod_m31(SWAP32(cd[0]));
+  uint32_t cd1 = parve_mod_m31(SWAP32(cd[1]));
 
   for (uint32_t i = 0; i < input_dwords / 2; i++)
   {
-    out0 += (uint64_t)SWAP32(input[0]) * 0xE79A9C1;
-    out0 = (out0 % 0x7FFFFFFF) * ab0;
-    out0 += ab1;
-    out0 = out0 % 0x7FFFFFFF;
+    uint32_t in0 = SWAP32(input[0]);
+    uint32_t in1 = SWAP32(input[1]);
+
+    out0 = parve_mod_m31(out0 + (uint64_t)in0 * 0xE79A9C1);
+    out0 = parve_mod_m31((uint64_t)out0 * ab0 + ab1);
 
     out1 += out0;
 
-    out0 = (uint64_t)(SWAP32(input[1]) + out0) * cd0;
-    out0 = (out0 % 0x7FFFFFFF) + cd1;
-    out0 = out0 % 0x7FFFFFFF;
+    out0 = parve_mod_m31((uint64_t)parve_mod_m31((uint64_t)in1 + out0) * cd0);
+    out0 = parve_mod_m31((uint64_t)out0 + cd1);
 
     out1 += out0;
 
     input += 2;
   }
-  out0 = SWAP32((out0 + ab1) % 0x7FFFFFFF);
-  out1 = SWAP32((out1 + cd1) % 0x7FFFFFFF);
-  memcpy(output, &out0,  sizeof(uint32_t));
-  memcpy(output+1, &out1,  sizeof(uint32_t));
-  // output[0] = SWAP32((out0 + ab1) % 0x7FFFFFFF);
-  // output[1] = SWAP32((out1 + cd1) % 0x7FFFFFFF);
+  uint32_t result[2];
+  result[0] = SWAP32(parve_mod_m31((uint64_t)out0 + ab1));
+  result[1] = SWAP32(parve_mod_m31(out1 + cd1));
+  memcpy(output, result, sizeof(result));
 }
@@ -0,0 +1,6 @@
+#pragma once
+
+#include <stdint.h>
+
+// Host stand-in for the firmware RNG, see xsm3_test_util.h for seeding
+uint32_t furi_hal_random_get(void);
@@ -0,0 +1,210 @@
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define XSM3_BENCH_CYCLES() __rdtsc()
+#else
+#define XSM3_BENCH_CYCLES() 0
+#endif
+
+#include "excrypt.h"
+#include "usbdsec.h"
+#include "xsm3.h"
+#include "xsm3_test_util.h"
+
+#define XSM3_BENCH_BYTES 4096
+#define XSM3_BENCH_THREADS 4
+#define XSM3_BENCH_THREAD_HANDSHAKES 2000
+
+/*
+ * Cycles are the TSC on x86, which runs at a fixed rate that may differ from the core
+ * clock, elsewhere only nanoseconds are shown. Compare runs on the same machine.
+ */
+typedef struct {
+    struct timespec start;
+    uint64_t cycles;
+} Xsm3BenchTimer;
+
+static void bench_start(Xsm3BenchTimer* timer) {
+    clock_gettime(CLOCK_MONOTONIC, &timer->start);
+    timer->cycles = XSM3_BENCH_CYCLES();
+}
+
+static void bench_report(Xsm3BenchTimer* timer, const char* name, size_t ops, size_t bytes) {
+    uint64_t cycles = XSM3_BENCH_CYCLES() - timer->cycles;
+    struct timespec end;
+    clock_gettime(CLOCK_MONOTONIC, &end);
+    double ns = (end.tv_sec - timer->start.tv_sec) * 1e9 + (end.tv_nsec - timer->start.tv_nsec);
+    if (bytes) {
+        printf("%-22s %9.2f ns/B %9.2f cyc/B\n", name, ns / bytes, (double)cycles / bytes);
+    } else {
+        printf("%-22s %9.0f ns/op %9.0f cyc/op\n", name, ns / ops, (double)cycles / ops);
+    }
+}
+
+// Keeps results alive so the compiler can't drop the work
+static volatile uint8_t bench_sink;
+
+static void bench_primitives(void) {
+    static uint8_t input[XSM3_BENCH_BYTES];
+    static uint8_t output[XSM3_BENCH_BYTES];
+    uint8_t key[0x10];
+    uint8_t sbox[256];
+    uint8_t iv[8];
+    uint64_t keys[3];
+    const size_t rounds = 64;
+    Xsm3BenchTimer timer;
+    xsm3_test_fill(input, sizeof(input), 1);
+    xsm3_test_fill(key, sizeof(key), 2);
+    xsm3_test_fill(sbox, sizeof(sbox), 3);
+    xsm3_test_fill(iv, sizeof(iv), 4);
+    xsm3_test_fill((uint8_t*)keys, sizeof(keys), 5);
+
+    EXCRYPT_DES_STATE des;
+    bench_start(&timer);
+    for (size_t i = 0; i < rounds * 16; i++) {
+        ExCryptDesKey(&des, key + (i & 7));
+    }
+    bench_report(&timer, "des key", rounds * 16, 0);
+
+    bench_start(&timer);
+    for (size_t r = 0; r < rounds; r++) {
+        for (size_t i = 0; i < sizeof(input); i += 8) {
+            ExCryptDesEcb(&des, input + i, output + i, 1);
+        }
+    }
+    bench_report(&timer, "des ecb", 0, rounds * sizeof(input));
+
+    EXCRYPT_DES3_STATE des3;
+    ExCryptDes3Key(&des3, keys);
+    bench_start(&timer);
+    for (size_t r = 0; r < rounds; r++) {
+        uint8_t feed[8] = {0};
+        ExCryptDes3Cbc(&des3, input, sizeof(input), output, feed, 1);
+    }
+    bench_report(&timer, "des3 cbc", 0, rounds * sizeof(input));
+
+    bench_start(&timer);
+    for (size_t r = 0; r < rounds; r++) {
+        ExCryptSha(input, sizeof(input), NULL, 0, NULL, 0, output, 0x14);
+    }
+    bench_report(&timer, "sha", 0, rounds * sizeof(input));
+
+    bench_start(&timer);
+    for (size_t r = 0; r < rounds; r++) {
+        ExCryptParveCbcMac(key, sbox, iv, input, sizeof(input), output);
+    }
+    bench_report(&timer, "parve cbc mac", 0, rounds * sizeof(input));
+
+    uint32_t ab[2];
+    uint32_t cd[2];
+    memcpy(ab, key, sizeof(ab));
+    memcpy(cd, key + 8, sizeof(cd));
+    bench_start(&timer);
+    for (size_t r = 0; r < rounds; r++) {
+        ExCryptChainAndSumMac(cd, ab, (const uint32_t*)input, sizeof(input) / 4, (uint32_t*)output);
+    }
+    bench_report(&timer, "chain and sum", 0, rounds * sizeof(input));
+
+    // The handshake only ever passes short buffers, setup dominates these
+    bench_start(&timer);
+    for (size_t r = 0; r < rounds * 16; r++) {
+        UsbdSecXSM3AuthenticationCrypt(key, input, 0x30, output, 1);
+    }
+    bench_report(&timer, "usbdsec crypt 0x30", rounds * 16, 0);
+
+    bench_start(&timer);
+    for (size_t r = 0; r < rounds * 16; r++) {
+        UsbdSecXSM3AuthenticationMac(key, NULL, input, 0x18, output);
+    }
+    bench_report(&timer, "usbdsec mac 0x18", rounds * 16, 0);
+
+    bench_start(&timer);
+    for (size_t r = 0; r < rounds * 16; r++) {
+        UsbdSecXSMAuthenticationAcr(input, input + 0x20, key, output);
+    }
+    bench_report(&timer, "usbdsec acr", rounds * 16, 0);
+
+    bench_sink = output[0];
+}
+
+static void handshake_setup(Xsm3Context* ctx, Xsm3KeyCache* cache, uint32_t seed) {
+    uint8_t serial[0x0C];
+    xsm3_test_serial(serial, seed);
+    xsm3_context_init(ctx);
+    xsm3_context_set_key_cache(ctx, cache);
+    xsm3_context_set_vid_pid(ctx, serial, 0x1430, 0x1F17);
+    xsm3_context_set_identification_data(ctx, ctx->id_data);
+}
+
+static void bench_handshake(Xsm3KeyCache* cache, const char* init_name, const char* verify_name) {
+    const size_t count = 2000;
+    uint8_t init_packet[0x22];
+    uint8_t verify_packet[0x16];
+    Xsm3Context ctx;
+    Xsm3BenchTimer timer;
+    xsm3_test_init_packet(init_packet, 1);
+    xsm3_test_verify_packet(verify_packet, 2);
+
+    // Warms the cache, if there is one
+    handshake_setup(&ctx, cache, 1);
+    xsm3_context_do_challenge_init(&ctx, init_packet);
+
+    bench_start(&timer);
+    for (size_t i = 0; i < count; i++) {
+        handshake_setup(&ctx, cache, 1);
+        xsm3_context_do_challenge_init(&ctx, init_packet);
+    }
+    bench_report(&timer, init_name, count, 0);
+
+    bench_start(&timer);
+    for (size_t i = 0; i < count; i++) {
+        xsm3_context_do_challenge_verify(&ctx, verify_packet);
+    }
+    bench_report(&timer, verify_name, count, 0);
+    bench_sink = ctx.challenge_response[5];
+}
+
+static void* thread_handshakes(void* arg) {
+    uint32_t seed = (uint32_t)(uintptr_t)arg + 1;
+    uint8_t init_packet[0x22];
+    uint8_t verify_packet[0x16];
+    Xsm3Context ctx;
+    xsm3_test_init_packet(init_packet, seed);
+    xsm3_test_verify_packet(verify_packet, seed + 100);
+    for (size_t i = 0; i < XSM3_BENCH_THREAD_HANDSHAKES; i++) {
+        handshake_setup(&ctx, NULL, seed);
+        xsm3_context_do_challenge_init(&ctx, init_packet);
+        xsm3_context_do_challenge_verify(&ctx, verify_packet);
+    }
+    bench_sink = ctx.challenge_response[5];
+    return NULL;
+}
+
+static void bench_parallel(void) {
+    pthread_t threads[XSM3_BENCH_THREADS];
+    Xsm3BenchTimer timer;
+    bench_start(&timer);
+    for (uintptr_t i = 0; i < XSM3_BENCH_THREADS; i++) {
+        pthread_create(&threads[i], NULL, thread_handshakes, (void*)i);
+    }
+    for (size_t i = 0; i < XSM3_BENCH_THREADS; i++) {
+        pthread_join(threads[i], NULL);
+    }
+    char name[32];
+    snprintf(name, sizeof(name), "handshake x%d threads", XSM3_BENCH_THREADS);
+    bench_report(&timer, name, XSM3_BENCH_THREADS * XSM3_BENCH_THREAD_HANDSHAKES, 0);
+}
+
+int main(void) {
+    bench_primitives();
+    bench_handshake(NULL, "challenge init", "challenge verify");
+    Xsm3KeyCache cache;
+    xsm3_key_cache_init(&cache);
+    bench_handshake(&cache, "challenge init cached", "challenge verify cached");
+    bench_parallel();
+    return 0;
+}
@@ -0,0 +1,260 @@
+#include "xsm3_kat_cases.h"
+#include "xsm3_test_util.h"
+
+#include <string.h>
+
+#include "excrypt.h"
+#include "usbdsec.h"
+#include "xsm3.h"
+
+static size_t kat_des_parity(uint8_t* out) {
+    uint8_t key[0x18];
+    xsm3_test_fill(key, sizeof(key), 1);
+    ExCryptDesParity(key, sizeof(key), out);
+    return sizeof(key);
+}
+
+static size_t kat_des_ecb(uint8_t* out) {
+    size_t size = 0;
+    for (uint32_t k = 0; k < 8; k++) {
+        uint8_t key[8];
+        uint8_t input[32];
+        EXCRYPT_DES_STATE state;
+        xsm3_test_fill(key, sizeof(key), 100 + k);
+        xsm3_test_fill(input, sizeof(input), 200 + k);
+        ExCryptDesKey(&state, key);
+        for (size_t i = 0; i < sizeof(input); i += 8) {
+            ExCryptDesEcb(&state, input + i, out + size, 1);
+            ExCryptDesEcb(&state, input + i, out + size + 8, 0);
+            size += 16;
+        }
+    }
+    return size;
+}
+
+static size_t kat_des3_ecb(uint8_t* out) {
+    size_t size = 0;
+    for (uint32_t k = 0; k < 4; k++) {
+        uint64_t keys[3];
+        uint8_t input[32];
+        EXCRYPT_DES3_STATE state;
+        xsm3_test_fill((uint8_t*)keys, sizeof(keys), 300 + k);
+        xsm3_test_fill(input, sizeof(input), 400 + k);
+        ExCryptDes3Key(&state, keys);
+        for (size_t i = 0; i < sizeof(input); i += 8) {
+            ExCryptDes3Ecb(&state, input + i, out + size, 1);
+            ExCryptDes3Ecb(&state, input + i, out + size + 8, 0);
+            size += 16;
+        }
+    }
+    return size;
+}
+
+static size_t kat_des3_cbc(uint8_t* out) {
+    size_t size = 0;
+    for (uint32_t k = 0; k < 4; k++) {
+        uint64_t keys[3];
+        uint8_t input[64];
+        uint8_t feed[8];
+        EXCRYPT_DES3_STATE state;
+        xsm3_test_fill((uint8_t*)keys, sizeof(keys), 500 + k);
+        xsm3_test_fill(input, sizeof(input), 600 + k);
+        ExCryptDes3Key(&state, keys);
+        for (uint8_t encrypt = 0; encrypt < 2; encrypt++) {
+            xsm3_test_fill(feed, sizeof(feed), 700 + k);
+            ExCryptDes3Cbc(&state, input, sizeof(input), out + size, feed, encrypt);
+            size += sizeof(input);
+            memcpy(out + size, feed, sizeof(feed));
+            size += sizeof(feed);
+        }
+    }
+    return size;
+}
+
+static size_t kat_sha(uint8_t* out) {
+    // Around the 55/56 byte padding edge and the 64 byte block edge
+    static const uint32_t lengths[] = {0, 1, 3, 55, 56, 63, 64, 65, 119, 128, 200};
+    uint8_t input[200];
+    size_t size = 0;
+    for (size_t i = 0; i < sizeof(lengths) / sizeof(lengths[0]); i++) {
+        uint32_t length = lengths[i];
+        xsm3_test_fill(input, length, 800 + i);
+        uint32_t a = length / 3;
+        uint32_t b = length / 2 - a / 2;
+        ExCryptSha(input, a, input + a, b, input + a + b, length - a - b, out + size, 0x14);
+        size += 0x14;
+        ExCryptSha(input, length, NULL, 0, NULL, 0, out + size, 0x0C);
+        size += 0x0C;
+    }
+    return size;
+}
+
+static size_t kat_sha_stream(uint8_t* out) {
+    static const uint32_t chunks[] = {1, 7, 63, 64, 100};
+    uint8_t input[300];
+    size_t size = 0;
+    xsm3_test_fill(input, sizeof(input), 900);
+    for (size_t i = 0; i < sizeof(chunks) / sizeof(chunks[0]); i++) {
+        EXCRYPT_SHA_STATE state;
+        ExCryptShaInit(&state);
+        for (uint32_t offset = 0; offset < sizeof(input); offset += chunks[i]) {
+            uint32_t length = sizeof(input) - offset;
+            ExCryptShaUpdate(&state, input + offset, length < chunks[i] ? length : chunks[i]);
+        }
+        ExCryptShaFinal(&state, out + size, 0x14);
+        size += 0x14;
+    }
+    return size;
+}
+
+static size_t kat_parve_ecb(uint8_t* out) {
+    uint8_t sbox[256];
+    size_t size = 0;
+    xsm3_test_fill(sbox, sizeof(sbox), 1000);
+    for (uint32_t k = 0; k < 8; k++) {
+        uint8_t key[8];
+        uint8_t input[8];
+        xsm3_test_fill(key, sizeof(key), 1100 + k);
+        xsm3_test_fill(input, sizeof(input), 1200 + k);
+        ExCryptParveEcb(key, sbox, input, out + size);
+        size += 8;
+    }
+    return size;
+}
+
+static size_t kat_parve_cbc_mac(uint8_t* out) {
+    static const uint32_t lengths[] = {0, 8, 64, 128, 130};
+    uint8_t sbox[256];
+    uint8_t key[8];
+    uint8_t iv[8];
+    uint8_t input[130];
+    size_t size = 0;
+    xsm3_test_fill(sbox, sizeof(sbox), 1300);
+    xsm3_test_fill(key, sizeof(key), 1301);
+    xsm3_test_fill(iv, sizeof(iv), 1302);
+    xsm3_test_fill(input, sizeof(input), 1303);
+    for (size_t i = 0; i < sizeof(lengths) / sizeof(lengths[0]); i++) {
+        ExCryptParveCbcMac(key, sbox, iv, input, lengths[i], out + size);
+        size += 8;
+    }
+    return size;
+}
+
+static size_t kat_chain_and_sum(uint8_t* out) {
+    static const uint32_t dwords[] = {0, 2, 8, 32, 33};
+    uint32_t input[33];
+    size_t size = 0;
+    for (size_t i = 0; i < sizeof(dwords) / sizeof(dwords[0]); i++) {
+        uint32_t cd[2];
+        uint32_t ab[2];
+        uint32_t mac[2];
+        xsm3_test_fill((uint8_t*)cd, sizeof(cd), 1400 + i);
+        xsm3_test_fill((uint8_t*)ab, sizeof(ab), 1500 + i);
+        xsm3_test_fill((uint8_t*)input, sizeof(input), 1600 + i);
+        ExCryptChainAndSumMac(cd, ab, input, dwords[i], mac);
+        memcpy(out + size, mac, sizeof(mac));
+        size += sizeof(mac);
+    }
+    // Inputs at and above 2^31 - 1 take the reduction's edge cases
+    uint32_t cd[2] = {0xFFFFFFFF, 0xFFFFFF7F};
+    uint32_t ab[2] = {0x7FFFFFFF, 0xFEFFFFFF};
+    uint32_t mac[2];
+    memset(input, 0xFF, sizeof(input));
+    ExCryptChainAndSumMac(cd, ab, input, 32, mac);
+    memcpy(out + size, mac, sizeof(mac));
+    return size + sizeof(mac);
+}
+
+static size_t kat_usbdsec_crypt(uint8_t* out) {
+    static const size_t lengths[] = {0x08, 0x10, 0x30};
+    uint8_t key[0x10];
+    uint8_t input[0x30];
+    size_t size = 0;
+    for (size_t i = 0; i < sizeof(lengths) / sizeof(lengths[0]); i++) {
+        xsm3_test_fill(key, sizeof(key), 1700 + i);
+        xsm3_test_fill(input, sizeof(input), 1800 + i);
+        for (uint8_t encrypt = 0; encrypt < 2; encrypt++) {
+            UsbdSecXSM3AuthenticationCrypt(key, input, lengths[i], out + size, encrypt);
+            size += lengths[i];
+        }
+    }
+    return size;
+}
+
+static size_t kat_usbdsec_mac(uint8_t* out) {
+    static const size_t lengths[] = {0x08, 0x10, 0x28};
+    uint8_t key[0x10];
+    uint8_t salt[0x10];
+    uint8_t input[0x28];
+    size_t size = 0;
+    for (size_t i = 0; i < sizeof(lengths) / sizeof(lengths[0]); i++) {
+        xsm3_test_fill(key, sizeof(key), 1900 + i);
+        xsm3_test_fill(input, sizeof(input), 2000 + i);
+        UsbdSecXSM3AuthenticationMac(key, NULL, input, lengths[i], out + size);
+        size += 8;
+        // The salt is a counter that is bumped in place
+        xsm3_test_fill(salt, sizeof(salt), 2100 + i);
+        UsbdSecXSM3AuthenticationMac(key, salt, input, lengths[i], out + size);
+        size += 8;
+        memcpy(out + size, salt, sizeof(salt));
+        size += sizeof(salt);
+    }
+    return size;
+}
+
+static size_t kat_usbdsec_acr(uint8_t* out) {
+    size_t size = 0;
+    for (uint32_t k = 0; k < 4; k++) {
+        uint8_t console_id[8];
+        uint8_t input[0x20];
+        uint8_t key[8];
+        xsm3_test_fill(console_id, sizeof(console_id), 2200 + k);
+        xsm3_test_fill(input, sizeof(input), 2300 + k);
+        xsm3_test_fill(key, sizeof(key), 2400 + k);
+        UsbdSecXSMAuthenticationAcr(console_id, input, key, out + size);
+        size += 8;
+    }
+    return size;
+}
+
+static size_t kat_handshake(uint8_t* out) {
+    size_t size = 0;
+    for (uint32_t seed = 1; seed <= XSM3_KAT_HANDSHAKES; seed++) {
+        uint8_t serial[0x0C];
+        uint8_t init_packet[0x22];
+        uint8_t verify_packet[0x16];
+        xsm3_test_serial(serial, seed);
+        xsm3_test_init_packet(init_packet, seed * 3 + 1);
+        xsm3_test_verify_packet(verify_packet, seed * 3 + 2);
+
+        xsm3_set_vid_pid(serial, XSM3_KAT_VID, XSM3_KAT_PID);
+        xsm3_initialise_state();
+        xsm3_set_identification_data(xsm3_id_data_ms_controller);
+        xsm3_test_seed(seed);
+        xsm3_do_challenge_init(init_packet);
+        memcpy(out + size, xsm3_challenge_response, 0x30);
+        xsm3_do_challenge_verify(verify_packet);
+        memcpy(out + size + 0x30, xsm3_challenge_response, 0x30);
+        memcpy(out + size + 0x60, xsm3_console_id, 0x08);
+        size += XSM3_KAT_HANDSHAKE_SIZE;
+    }
+    return size;
+}
+
+const Xsm3KatCase xsm3_kat_cases[] = {
+    {"des_parity", kat_des_parity},
+    {"des_ecb", kat_des_ecb},
+    {"des3_ecb", kat_des3_ecb},
+    {"des3_cbc", kat_des3_cbc},
+    {"sha", kat_sha},
+    {"sha_stream", kat_sha_stream},
+    {"parve_ecb", kat_parve_ecb},
+    {"parve_cbc_mac", kat_parve_cbc_mac},
+    {"chain_and_sum", kat_chain_and_sum},
+    {"usbdsec_crypt", kat_usbdsec_crypt},
+    {"usbdsec_mac", kat_usbdsec_mac},
+    {"usbdsec_acr", kat_usbdsec_acr},
+    {"handshake", kat_handshake},
+};
+
+const size_t xsm3_kat_case_count = sizeof(xsm3_kat_cases) / sizeof(xsm3_kat_cases[0]);
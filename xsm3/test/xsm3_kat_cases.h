@@ -0,0 +1,25 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define XSM3_KAT_OUTPUT_MAX 2048
+
+/*
+ * Each case runs fixed, seeded inputs through the library and appends every output
+ * it produced. Only the API of baseline ec803f6 is used, so xsm3_kat_gen can be built
+ * against that tree to capture the vectors and xsm3_test against this one to check them.
+ */
+typedef struct {
+    const char* name;
+    size_t (*run)(uint8_t* out);
+} Xsm3KatCase;
+
+extern const Xsm3KatCase xsm3_kat_cases[];
+extern const size_t xsm3_kat_case_count;
+
+// Handshake used by the handshake vectors, also run on contexts by xsm3_test
+#define XSM3_KAT_HANDSHAKES 4
+#define XSM3_KAT_HANDSHAKE_SIZE (0x30 + 0x30 + 0x08)
+#define XSM3_KAT_VID 0x1430
+#define XSM3_KAT_PID 0x1F17
@@ -0,0 +1,26 @@
+// Prints xsm3_kat_vectors.h, build it against the tree whose outputs are the reference
+#include <stdio.h>
+
+#include "xsm3_kat_cases.h"
+
+int main(void) {
+    static uint8_t out[XSM3_KAT_OUTPUT_MAX];
+    printf("#pragma once\n\n");
+    printf("// Generated by xsm3_kat_gen from the reference tree named in the Makefile, do not edit\n\n");
+    printf("#include <stddef.h>\n#include <stdint.h>\n\n");
+    for (size_t i = 0; i < xsm3_kat_case_count; i++) {
+        size_t size = xsm3_kat_cases[i].run(out);
+        printf("static const uint8_t xsm3_kat_%s[%zu] = {", xsm3_kat_cases[i].name, size);
+        for (size_t j = 0; j < size; j++) {
+            printf("%s0x%02X,", j % 12 ? " " : "\n    ", out[j]);
+        }
+        printf("\n};\n\n");
+    }
+    printf("static const struct {\n    const char* name;\n    const uint8_t* data;\n    size_t size;\n} xsm3_kat_vectors[] = {\n");
+    for (size_t i = 0; i < xsm3_kat_case_count; i++) {
+        const char* name = xsm3_kat_cases[i].name;
+        printf("    {\"%s\", xsm3_kat_%s, sizeof(xsm3_kat_%s)},\n", name, name, name);
+    }
+    printf("};\n");
+    return 0;
+}
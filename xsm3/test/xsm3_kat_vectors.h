@@ -0,0 +1,291 @@
+#pragma once
+
+// Generated by xsm3_kat_gen from the reference tree named in the Makefile, do not edit
+
+#include <stddef.h>
+#include <stdint.h>
+
+static const uint8_t xsm3_kat_des_parity[24] = {
+    0x50, 0xCD, 0x69, 0xFE, 0x80, 0xBE, 0x8E, 0x65, 0x57, 0x3B, 0xD0, 0x4E,
+    0x17, 0x27, 0xF3, 0x99, 0xC3, 0x6F, 0x80, 0xD4, 0xAE, 0xD9, 0x1C, 0xF0,
+};
+
+static const uint8_t xsm3_kat_des_ecb[512] = {
+    0xBE, 0x37, 0xDE, 0x73, 0xB8, 0x8D, 0x0F, 0x8D, 0x97, 0x08, 0x0D, 0x0A,
+    0xC3, 0xD3, 0x8F, 0xAF, 0x6C, 0x78, 0xD1, 0xDC, 0x69, 0x3E, 0x7D, 0xE0,
+    0xD6, 0xD6, 0x70, 0x77, 0xEC, 0xF2, 0xE7, 0x5F, 0xB1, 0x18, 0x70, 0x3B,
+    0x25, 0xF1, 0xED, 0xB6, 0x68, 0xF2, 0x39, 0xFC, 0x8D, 0x03, 0x4B, 0xF4,
+    0x9F, 0x2A, 0x54, 0x97, 0x43, 0x56, 0x98, 0x53, 0x6A, 0x05, 0x47, 0x7D,
+    0x16, 0x07, 0x47, 0x41, 0x8B, 0xE5, 0x85, 0xBD, 0xC3, 0xFC, 0x28, 0x0B,
+    0x53, 0x2E, 0xCA, 0xA9, 0x40, 0x63, 0xD0, 0xD4, 0xD8, 0xB9, 0xEE, 0xF5,
+    0x6F, 0x02, 0xF1, 0x5C, 0x77, 0x69, 0xCC, 0xBC, 0xD1, 0xEF, 0xD1, 0x29,
+    0xE8, 0x96, 0xA3, 0x4E, 0x01, 0xD9, 0x6A, 0x55, 0xA1, 0xCC, 0x3B, 0x55,
+    0xB5, 0x9C, 0xC3, 0x00, 0x99, 0xF0, 0x90, 0x0A, 0x6F, 0xFE, 0x79, 0x1B,
+    0x15, 0xE6, 0x1E, 0xC5, 0xFC, 0x4B, 0xD4, 0x2A, 0x42, 0xF9, 0xFA, 0xBF,
+    0x02, 0x5A, 0x07, 0x86, 0x9F, 0x5C, 0x14, 0x54, 0xA0, 0xDA, 0x5E, 0x29,
+    0xB0, 0x58, 0x73, 0x60, 0xF6, 0x8A, 0xF8, 0x91, 0xBE, 0x30, 0xBE, 0xC5,
+    0xC6, 0x41, 0x92, 0x8F, 0x6B, 0xAE, 0x58, 0x96, 0x94, 0x0F, 0x46, 0x3E,
+    0xAA, 0x41, 0x87, 0xFA, 0x43, 0x69, 0x58, 0x2D, 0xBA, 0x4F, 0xF3, 0xA7,
+    0x62, 0x57, 0x22, 0x13, 0x3C, 0xA5, 0x59, 0x68, 0x71, 0x3B, 0xE4, 0x32,
+    0xDB, 0xD3, 0x1F, 0xB6, 0xCE, 0x74, 0x7D, 0x42, 0x9E, 0xFF, 0xB4, 0x1C,
+    0xB6, 0x3B, 0x25, 0x2E, 0xDF, 0x18, 0xE1, 0x89, 0xD5, 0x6F, 0x8D, 0x15,
+    0x9B, 0x4C, 0x29, 0x5C, 0xD2, 0xA0, 0xE5, 0x73, 0x0A, 0x6A, 0xD0, 0x95,
+    0x60, 0x0A, 0x3B, 0x8B, 0xF7, 0x39, 0xCB, 0x4F, 0xA6, 0xC1, 0xAC, 0x59,
+    0xAD, 0xD5, 0x68, 0x8E, 0xBE, 0xA0, 0x62, 0xF7, 0xF7, 0x06, 0x63, 0x19,
+    0x62, 0xC4, 0x66, 0x60, 0xFE, 0xBE, 0x20, 0xBC, 0x55, 0x4F, 0x39, 0x3F,
+    0x90, 0xBA, 0xAE, 0xB3, 0x86, 0x1A, 0x25, 0x80, 0xC3, 0xCA, 0xF2, 0x0B,
+    0x52, 0xC8, 0xE7, 0xE1, 0xFB, 0xD6, 0xB8, 0x2D, 0xE7, 0x48, 0x22, 0xDC,
+    0x9A, 0xC3, 0x73, 0x66, 0xB4, 0xEF, 0x37, 0x1C, 0x72, 0x4D, 0x20, 0xE9,
+    0x0C, 0x16, 0x04, 0xE7, 0x48, 0x4E, 0x27, 0xDE, 0xEF, 0x5F, 0x20, 0xE5,
+    0xB6, 0xCB, 0xDF, 0x12, 0x0D, 0x8A, 0xF6, 0x80, 0x0A, 0x09, 0x68, 0x76,
+    0xC3, 0x18, 0xF0, 0x17, 0x97, 0x65, 0xEE, 0x2E, 0xFD, 0x5A, 0xDB, 0x26,
+    0x8E, 0x96, 0xFC, 0x74, 0x57, 0xE4, 0xA0, 0xA6, 0x40, 0xC8, 0x2B, 0x23,
+    0x18, 0x3C, 0xCC, 0xB9, 0x53, 0x23, 0xC0, 0x34, 0x45, 0xCD, 0xDB, 0xFD,
+    0x09, 0x1C, 0x8D, 0x2B, 0x49, 0x1B, 0xE1, 0x2F, 0xC8, 0x34, 0xEE, 0x90,
+    0xF8, 0xE6, 0xB4, 0xAC, 0x19, 0x9A, 0x86, 0x45, 0x45, 0x1A, 0x2E, 0xBD,
+    0xBB, 0x58, 0x88, 0x22, 0xCF, 0xE5, 0x91, 0x02, 0x90, 0x4B, 0x14, 0xCB,
+    0xFD, 0x54, 0x68, 0xB9, 0xD6, 0x1D, 0x70, 0x99, 0xAF, 0x5B, 0xE1, 0xD3,
+    0x11, 0x45, 0x4D, 0xF4, 0x6E, 0xFC, 0xC2, 0xAC, 0x85, 0x84, 0xEE, 0xF4,
+    0xBD, 0xF7, 0xC6, 0x73, 0xFE, 0x33, 0x9C, 0xDA, 0x29, 0x72, 0x72, 0xF9,
+    0xC0, 0x45, 0x24, 0xA4, 0x5E, 0xF9, 0x95, 0x53, 0xFD, 0xD3, 0xDC, 0x2D,
+    0xB9, 0x7B, 0xCD, 0xF9, 0x22, 0xA3, 0xEF, 0xC6, 0xC3, 0xAD, 0xAC, 0x6A,
+    0xFB, 0x97, 0xA1, 0x80, 0x61, 0xFE, 0xD0, 0x24, 0xFB, 0xC0, 0x7E, 0x57,
+    0x9A, 0xF6, 0x1C, 0xE3, 0xC8, 0xAC, 0x1B, 0x73, 0xB2, 0x69, 0x87, 0x6E,
+    0x70, 0x2D, 0xD6, 0xF9, 0xA4, 0xA7, 0x58, 0x33, 0x20, 0x3B, 0x70, 0x3A,
+    0x17, 0xDD, 0x39, 0x2D, 0xFC, 0x77, 0x0D, 0xC8, 0xD4, 0x84, 0x64, 0x84,
+    0xB4, 0x69, 0xBB, 0x83, 0xF2, 0xB3, 0xB3, 0xA2,
+};
+
+static const uint8_t xsm3_kat_des3_ecb[256] = {
+    0x5B, 0xE8, 0xD3, 0xD6, 0xBF, 0xD6, 0x64, 0x75, 0xC7, 0x3C, 0xAA, 0x64,
+    0x00, 0x3C, 0x73, 0xD4, 0x03, 0xD3, 0x66, 0x30, 0x23, 0x4F, 0xF8, 0x65,
+    0x21, 0xF5, 0xAE, 0xC3, 0x73, 0x9D, 0xD9, 0xE4, 0xD8, 0xC0, 0xA0, 0x59,
+    0x6C, 0xC5, 0x26, 0xF3, 0x28, 0xC3, 0x50, 0x90, 0x81, 0xBA, 0x48, 0x75,
+    0xEC, 0x93, 0x61, 0x99, 0x73, 0xFA, 0x84, 0x6C, 0x93, 0x86, 0x06, 0x3A,
+    0x5C, 0xDD, 0x48, 0xBE, 0x96, 0x1D, 0x99, 0xC7, 0x98, 0x79, 0x5B, 0x1D,
+    0x61, 0x6A, 0x5A, 0x7C, 0x4D, 0xF0, 0xD3, 0xD9, 0x13, 0xE2, 0xDD, 0xA6,
+    0x99, 0xA0, 0xF7, 0xF0, 0xA7, 0x25, 0x4B, 0xAC, 0xF7, 0xD6, 0x0B, 0xED,
+    0x50, 0x54, 0xA8, 0xB5, 0xD8, 0xB1, 0x11, 0xC0, 0x5B, 0xA5, 0x10, 0x0C,
+    0xB4, 0x95, 0x14, 0x9F, 0x5C, 0x3D, 0x9B, 0xD4, 0x64, 0x04, 0x40, 0x09,
+    0xE7, 0xBB, 0x44, 0x01, 0x16, 0x05, 0xA3, 0x43, 0xE0, 0x44, 0x95, 0xEA,
+    0x58, 0x52, 0x76, 0xEE, 0x9D, 0x27, 0xE1, 0x7A, 0x02, 0xA0, 0x2B, 0xD3,
+    0x8A, 0xAE, 0x65, 0xA7, 0x0B, 0xEC, 0x5A, 0xFB, 0x7D, 0xB5, 0xFB, 0xFF,
+    0xF9, 0xB8, 0x44, 0x3D, 0xAE, 0x2B, 0xE0, 0xCB, 0x45, 0x6A, 0x34, 0x7B,
+    0x76, 0xCA, 0xBA, 0xBE, 0xA6, 0xB7, 0x5D, 0x9E, 0xAD, 0xEF, 0x7D, 0xB8,
+    0x06, 0x06, 0xF6, 0xBD, 0x48, 0x7B, 0xE4, 0xFE, 0xBE, 0x46, 0xC5, 0x92,
+    0xAC, 0x22, 0xE2, 0xEE, 0x19, 0x30, 0x8E, 0x79, 0x15, 0x79, 0xF6, 0x21,
+    0x30, 0x28, 0x14, 0x08, 0xE4, 0x71, 0x0D, 0xC6, 0x77, 0x77, 0xCC, 0x11,
+    0x57, 0x3C, 0x22, 0x02, 0x77, 0xBE, 0xAC, 0x3A, 0xCB, 0xBA, 0x17, 0x20,
+    0x29, 0x27, 0x75, 0x04, 0x89, 0x0E, 0x87, 0xFF, 0xF3, 0x4B, 0x4F, 0x6A,
+    0x50, 0x28, 0x28, 0xE6, 0xCE, 0x64, 0x87, 0xDA, 0x60, 0x3E, 0xAA, 0x8B,
+    0xE2, 0xB8, 0x57, 0xD1,
+};
+
+static const uint8_t xsm3_kat_des3_cbc[576] = {
+    0x40, 0xCA, 0x74, 0x33, 0xB4, 0x5F, 0xB6, 0xAE, 0xAF, 0x12, 0x8A, 0xD2,
+    0xEB, 0x3D, 0x6F, 0x9D, 0xE0, 0xD6, 0xCA, 0x4F, 0x1F, 0xA1, 0x46, 0x63,
+    0xBB, 0x31, 0x98, 0xCE, 0x08, 0x2E, 0x2B, 0x52, 0x5D, 0x73, 0x0F, 0x4F,
+    0xEA, 0xA0, 0xC0, 0xEB, 0xBD, 0x38, 0x37, 0xFB, 0x8D, 0xBF, 0xF6, 0xC2,
+    0x44, 0x06, 0xA3, 0x02, 0x50, 0xED, 0xA2, 0x4B, 0xED, 0x17, 0xF7, 0xB4,
+    0x20, 0x6B, 0x1A, 0x77, 0xC6, 0x99, 0x41, 0xF2, 0x37, 0x9C, 0x09, 0xC2,
+    0x8F, 0xE9, 0xB0, 0xD0, 0xC2, 0x4B, 0x65, 0x20, 0xDB, 0xC0, 0x0A, 0x60,
+    0xC7, 0xB2, 0xBF, 0x6A, 0x93, 0x4D, 0xF7, 0xD7, 0xDD, 0x63, 0xFF, 0x2B,
+    0x27, 0x20, 0xD1, 0x86, 0xE8, 0x04, 0xF6, 0x47, 0x61, 0xA4, 0x43, 0x5D,
+    0x08, 0xC9, 0xA0, 0xE9, 0xED, 0x1D, 0x02, 0x75, 0x1C, 0x1E, 0x7C, 0x9F,
+    0xA5, 0xD2, 0xA0, 0x6D, 0xD4, 0x1D, 0x4A, 0x89, 0x2A, 0x30, 0xFD, 0x14,
+    0xF7, 0x35, 0xE5, 0x66, 0x2A, 0x30, 0xFD, 0x14, 0xF7, 0x35, 0xE5, 0x66,
+    0xE5, 0xA3, 0x69, 0x29, 0x00, 0xF7, 0xC0, 0xF9, 0x9A, 0x96, 0x69, 0x49,
+    0x7C, 0x96, 0x1C, 0x19, 0x3B, 0xDC, 0x6C, 0xA0, 0x19, 0x7A, 0x85, 0xCA,
+    0x6A, 0x01, 0x1B, 0x56, 0xB2, 0x95, 0xE6, 0x61, 0x21, 0x00, 0x3F, 0x70,
+    0xB4, 0x64, 0xF9, 0xB1, 0x85, 0x6E, 0x47, 0xC8, 0xCE, 0xDA, 0xF5, 0xB9,
+    0x3E, 0xA7, 0x07, 0x81, 0x91, 0x61, 0x51, 0x35, 0xC6, 0x04, 0x85, 0xC0,
+    0xDE, 0xB6, 0x3F, 0x83, 0x0E, 0xE3, 0x39, 0x4C, 0xF4, 0xEE, 0x3D, 0x2F,
+    0x28, 0x9F, 0x1E, 0x63, 0x26, 0x98, 0x23, 0x5E, 0xA4, 0x73, 0xF8, 0x22,
+    0x93, 0x0A, 0x5B, 0x8E, 0xF9, 0x15, 0x7A, 0x8E, 0xE7, 0x21, 0xA5, 0x3E,
+    0x99, 0x12, 0xE9, 0x44, 0x3E, 0xE2, 0x22, 0x7A, 0xB1, 0x20, 0xBE, 0x31,
+    0x06, 0x5F, 0xB3, 0x1F, 0xE2, 0xDF, 0xB7, 0x43, 0xC2, 0x64, 0xE5, 0xD5,
+    0x09, 0xCF, 0x0E, 0x79, 0x85, 0x5D, 0x99, 0x43, 0xAE, 0xF3, 0xF9, 0x16,
+    0x33, 0x66, 0xB4, 0xAE, 0xAE, 0xF3, 0xF9, 0x16, 0x33, 0x66, 0xB4, 0xAE,
+    0xB5, 0x6D, 0x7F, 0x26, 0xAA, 0x3A, 0x51, 0x3E, 0x7C, 0x45, 0x59, 0x9F,
+    0xA5, 0x3F, 0x12, 0x50, 0xFF, 0x78, 0xFC, 0xAD, 0x95, 0x64, 0x39, 0x34,
+    0xFE, 0x4C, 0x56, 0x2C, 0x83, 0x1B, 0xE1, 0x0E, 0xDE, 0x94, 0xE5, 0x3F,
+    0xD0, 0x49, 0x84, 0x0D, 0x59, 0x35, 0x17, 0x9A, 0x08, 0xA8, 0x99, 0x08,
+    0xB9, 0x80, 0x35, 0x78, 0x31, 0x43, 0xCD, 0xB2, 0x56, 0xB5, 0xA5, 0xC0,
+    0x72, 0x2B, 0xD2, 0x25, 0x45, 0x7B, 0x83, 0x04, 0x84, 0x29, 0xD6, 0x44,
+    0xDB, 0xC2, 0xEF, 0x35, 0x56, 0x57, 0xBB, 0x6A, 0xCF, 0xFD, 0x98, 0x87,
+    0x84, 0xCD, 0xC1, 0x6F, 0xF2, 0x41, 0xBF, 0x2B, 0x0D, 0xD4, 0xF1, 0x7A,
+    0xB2, 0x61, 0xEA, 0xE3, 0x32, 0xA1, 0xC7, 0xDB, 0x28, 0x51, 0x80, 0xB2,
+    0xD2, 0x5D, 0x77, 0x19, 0xFA, 0x61, 0xA4, 0x35, 0x93, 0xDA, 0x5A, 0x7E,
+    0xBE, 0x8A, 0xC0, 0x47, 0x1E, 0x6E, 0x04, 0xA4, 0xC8, 0x5F, 0x43, 0xCD,
+    0xA6, 0x5D, 0x9D, 0xCE, 0xC8, 0x5F, 0x43, 0xCD, 0xA6, 0x5D, 0x9D, 0xCE,
+    0xAC, 0x53, 0x1E, 0xA2, 0x4A, 0x85, 0x92, 0x52, 0x08, 0xFF, 0xD0, 0x44,
+    0x2C, 0x3F, 0x99, 0x36, 0x4C, 0xDC, 0xC3, 0xD3, 0x26, 0x41, 0x55, 0xB6,
+    0x85, 0xE5, 0xC5, 0x00, 0xF2, 0x30, 0x72, 0x7A, 0xB6, 0x9A, 0x7B, 0x84,
+    0x65, 0xDE, 0xFB, 0xE4, 0x62, 0x5D, 0xD3, 0x32, 0x30, 0xF7, 0xC4, 0xF7,
+    0xE7, 0x21, 0xF2, 0x5A, 0xA3, 0x83, 0x65, 0x2D, 0xBA, 0xD7, 0x9B, 0x03,
+    0x87, 0x22, 0x4A, 0x60, 0x45, 0x99, 0xF7, 0x14, 0x27, 0x2E, 0xA8, 0x69,
+    0xFE, 0xAA, 0xD9, 0xF7, 0x15, 0x73, 0x00, 0xBD, 0xA4, 0xDC, 0xF3, 0x6D,
+    0x47, 0x87, 0x98, 0x7B, 0xDF, 0xC4, 0x20, 0xE1, 0x24, 0x21, 0x7C, 0x0A,
+    0x60, 0x53, 0xBD, 0x5E, 0xC2, 0x80, 0x84, 0xA1, 0x02, 0x34, 0xB1, 0x9E,
+    0xE7, 0xC5, 0x57, 0x95, 0x04, 0x29, 0xC7, 0x38, 0xBC, 0x04, 0x86, 0x4F,
+    0x2F, 0x7B, 0x9F, 0x85, 0x5C, 0xF8, 0xBC, 0x60, 0x84, 0x26, 0x17, 0x0E,
+    0x0C, 0x0A, 0xC6, 0x5F, 0x84, 0x26, 0x17, 0x0E, 0x0C, 0x0A, 0xC6, 0x5F,
+};
+
+static const uint8_t xsm3_kat_sha[352] = {
+    0xDA, 0x39, 0xA3, 0xEE, 0x5E, 0x6B, 0x4B, 0x0D, 0x32, 0x55, 0xBF, 0xEF,
+    0x95, 0x60, 0x18, 0x90, 0xAF, 0xD8, 0x07, 0x09, 0xDA, 0x39, 0xA3, 0xEE,
+    0x5E, 0x6B, 0x4B, 0x0D, 0x32, 0x55, 0xBF, 0xEF, 0xAD, 0xC8, 0x3B, 0x19,
+    0xE7, 0x93, 0x49, 0x1B, 0x1C, 0x6E, 0xA0, 0xFD, 0x8B, 0x46, 0xCD, 0x9F,
+    0x32, 0xE5, 0x92, 0xFC, 0xAD, 0xC8, 0x3B, 0x19, 0xE7, 0x93, 0x49, 0x1B,
+    0x1C, 0x6E, 0xA0, 0xFD, 0x6B, 0x51, 0xED, 0x7B, 0xF7, 0xC5, 0x99, 0x3B,
+    0xE7, 0xE2, 0x85, 0x29, 0x12, 0xDE, 0x72, 0x66, 0x00, 0xA4, 0x2B, 0x69,
+    0x6B, 0x51, 0xED, 0x7B, 0xF7, 0xC5, 0x99, 0x3B, 0xE7, 0xE2, 0x85, 0x29,
+    0xEE, 0xDB, 0x0F, 0x85, 0x2E, 0xDC, 0x77, 0xDB, 0xA9, 0x48, 0xE9, 0xAD,
+    0x5D, 0x3B, 0x04, 0x7A, 0xBE, 0x24, 0xBF, 0xE8, 0xEE, 0xDB, 0x0F, 0x85,
+    0x2E, 0xDC, 0x77, 0xDB, 0xA9, 0x48, 0xE9, 0xAD, 0x33, 0xD0, 0x64, 0x5E,
+    0x0A, 0x7E, 0xBF, 0x25, 0xDE, 0xBB, 0x94, 0xC6, 0xE0, 0x92, 0xCE, 0xF5,
+    0x7F, 0xD9, 0xB8, 0xB0, 0x33, 0xD0, 0x64, 0x5E, 0x0A, 0x7E, 0xBF, 0x25,
+    0xDE, 0xBB, 0x94, 0xC6, 0x27, 0xE8, 0xCC, 0xDD, 0x2E, 0x1D, 0x44, 0x30,
+    0x01, 0xDE, 0x1B, 0xC0, 0xD6, 0x1E, 0x5A, 0xA7, 0x76, 0x0F, 0xA1, 0xE2,
+    0x27, 0xE8, 0xCC, 0xDD, 0x2E, 0x1D, 0x44, 0x30, 0x01, 0xDE, 0x1B, 0xC0,
+    0xFF, 0x42, 0x17, 0xCA, 0x05, 0x2F, 0x49, 0x43, 0x78, 0x24, 0x7D, 0x1C,
+    0xBB, 0xF9, 0x3A, 0x91, 0x1E, 0xD1, 0x15, 0x12, 0xFF, 0x42, 0x17, 0xCA,
+    0x05, 0x2F, 0x49, 0x43, 0x78, 0x24, 0x7D, 0x1C, 0x3C, 0x8D, 0xBE, 0x52,
+    0x49, 0xB5, 0x7F, 0x87, 0xFD, 0x3F, 0x5E, 0x53, 0x6F, 0xB5, 0x64, 0xE4,
+    0xC1, 0x90, 0x56, 0x50, 0x3C, 0x8D, 0xBE, 0x52, 0x49, 0xB5, 0x7F, 0x87,
+    0xFD, 0x3F, 0x5E, 0x53, 0x73, 0xDD, 0xA5, 0x83, 0xDC, 0xEF, 0xF0, 0x44,
+    0x1B, 0x7A, 0x7C, 0xAF, 0x4A, 0x50, 0xFC, 0x73, 0x27, 0xD2, 0xEA, 0x3D,
+    0x73, 0xDD, 0xA5, 0x83, 0xDC, 0xEF, 0xF0, 0x44, 0x1B, 0x7A, 0x7C, 0xAF,
+    0x10, 0x17, 0x0B, 0x19, 0xBE, 0x2B, 0x75, 0xE4, 0xA7, 0xB6, 0x99, 0x67,
+    0xCC, 0x80, 0x64, 0x60, 0xB2, 0xFB, 0x77, 0xBC, 0x10, 0x17, 0x0B, 0x19,
+    0xBE, 0x2B, 0x75, 0xE4, 0xA7, 0xB6, 0x99, 0x67, 0x28, 0x73, 0x63, 0x1F,
+    0x12, 0x70, 0x4E, 0x6A, 0xA1, 0x3F, 0x70, 0xB9, 0xC3, 0x3C, 0xBA, 0x89,
+    0x4D, 0x9A, 0x4A, 0x3F, 0x28, 0x73, 0x63, 0x1F, 0x12, 0x70, 0x4E, 0x6A,
+    0xA1, 0x3F, 0x70, 0xB9,
+};
+
+static const uint8_t xsm3_kat_sha_stream[100] = {
+    0x95, 0x0F, 0xB9, 0x02, 0x15, 0xB8, 0x57, 0x52, 0x0A, 0xDC, 0x95, 0x55,
+    0x09, 0xBA, 0x5E, 0x1B, 0xE2, 0xCA, 0xAC, 0xAF, 0x95, 0x0F, 0xB9, 0x02,
+    0x15, 0xB8, 0x57, 0x52, 0x0A, 0xDC, 0x95, 0x55, 0x09, 0xBA, 0x5E, 0x1B,
+    0xE2, 0xCA, 0xAC, 0xAF, 0x95, 0x0F, 0xB9, 0x02, 0x15, 0xB8, 0x57, 0x52,
+    0x0A, 0xDC, 0x95, 0x55, 0x09, 0xBA, 0x5E, 0x1B, 0xE2, 0xCA, 0xAC, 0xAF,
+    0x95, 0x0F, 0xB9, 0x02, 0x15, 0xB8, 0x57, 0x52, 0x0A, 0xDC, 0x95, 0x55,
+    0x09, 0xBA, 0x5E, 0x1B, 0xE2, 0xCA, 0xAC, 0xAF, 0x95, 0x0F, 0xB9, 0x02,
+    0x15, 0xB8, 0x57, 0x52, 0x0A, 0xDC, 0x95, 0x55, 0x09, 0xBA, 0x5E, 0x1B,
+    0xE2, 0xCA, 0xAC, 0xAF,
+};
+
+static const uint8_t xsm3_kat_parve_ecb[64] = {
+    0xEF, 0xE0, 0x8C, 0x6A, 0x0C, 0xFB, 0xF0, 0xB1, 0x30, 0x24, 0x9E, 0x85,
+    0x5E, 0x3F, 0xDC, 0x4C, 0xF2, 0xBC, 0x5E, 0xE4, 0x9A, 0x53, 0xB8, 0x6C,
+    0xB1, 0xB7, 0xE0, 0x8E, 0xFD, 0x01, 0x67, 0xE1, 0x70, 0x5C, 0xE7, 0xD9,
+    0x79, 0x7E, 0x46, 0xEA, 0x87, 0x0A, 0xED, 0x82, 0xFC, 0x93, 0xD5, 0x4F,
+    0x02, 0xBE, 0xB3, 0x07, 0xE2, 0x3E, 0x22, 0xE8, 0xA4, 0x85, 0x95, 0x61,
+    0x07, 0x53, 0x1F, 0x92,
+};
+
+static const uint8_t xsm3_kat_parve_cbc_mac[40] = {
+    0x5F, 0x3A, 0x11, 0xF6, 0x6E, 0x7C, 0x63, 0x48, 0x65, 0x46, 0xEB, 0xC7,
+    0xAA, 0x50, 0x44, 0x40, 0xD2, 0x46, 0x0A, 0x87, 0xA1, 0x45, 0xED, 0x7A,
+    0x98, 0xBC, 0x55, 0xB6, 0xD9, 0x04, 0x88, 0xC6, 0x98, 0xBC, 0x55, 0xB6,
+    0xD9, 0x04, 0x88, 0xC6,
+};
+
+static const uint8_t xsm3_kat_chain_and_sum[48] = {
+    0x10, 0x3B, 0xCA, 0x17, 0x6F, 0x21, 0x8F, 0xE0, 0x47, 0xCD, 0xAD, 0x12,
+    0x38, 0x1F, 0x6D, 0xED, 0x05, 0xC9, 0xDC, 0x04, 0x5C, 0x7A, 0xB9, 0x6A,
+    0x7C, 0x6D, 0xCF, 0xC7, 0x76, 0x09, 0x56, 0x84, 0x56, 0x1F, 0xB8, 0x09,
+    0x28, 0xDC, 0x20, 0x9C, 0x10, 0x40, 0x49, 0x3D, 0x1A, 0xA8, 0xC3, 0x92,
+};
+
+static const uint8_t xsm3_kat_usbdsec_crypt[144] = {
+    0x72, 0x6F, 0xF9, 0x96, 0xC0, 0x7C, 0xBD, 0xFD, 0x1D, 0x23, 0x91, 0xB4,
+    0x98, 0x6F, 0x1E, 0x8F, 0xE9, 0xB0, 0xB6, 0x79, 0xCD, 0x09, 0x18, 0x85,
+    0xF8, 0xCE, 0x0E, 0xC6, 0x92, 0x13, 0x58, 0xA1, 0x25, 0xCE, 0xFE, 0x44,
+    0xDB, 0x52, 0xCF, 0x5D, 0xD6, 0xB5, 0xC1, 0xBC, 0x6D, 0x8C, 0x88, 0xB0,
+    0x95, 0x35, 0x3C, 0xF8, 0x96, 0xE3, 0x87, 0xBC, 0xF4, 0xD3, 0xBE, 0x36,
+    0x3A, 0xA5, 0x3C, 0xF6, 0xAA, 0xAF, 0x56, 0xB2, 0x9A, 0xAB, 0x6F, 0x40,
+    0x3A, 0x04, 0x5A, 0x25, 0xF6, 0xB0, 0xA9, 0xFE, 0xBC, 0x71, 0xC7, 0xA0,
+    0x83, 0x13, 0x93, 0x62, 0x2C, 0x58, 0x5E, 0xFE, 0x85, 0xD9, 0x29, 0x23,
+    0xF0, 0xB1, 0x13, 0x8D, 0x5E, 0x0F, 0x4F, 0xAA, 0xBE, 0x47, 0x60, 0x3D,
+    0xE6, 0xF5, 0x4B, 0x03, 0x10, 0x71, 0x6E, 0x8E, 0x57, 0xD5, 0x63, 0xFB,
+    0x70, 0xE1, 0xBD, 0x0C, 0x38, 0xE6, 0x70, 0x94, 0xCD, 0x24, 0xC1, 0xD5,
+    0xC2, 0x46, 0x59, 0xB4, 0x4E, 0x01, 0x96, 0xC6, 0xEE, 0x37, 0x82, 0x89,
+};
+
+static const uint8_t xsm3_kat_usbdsec_mac[96] = {
+    0xC1, 0xA9, 0x06, 0x52, 0x83, 0xBA, 0xF7, 0xD8, 0x42, 0xC7, 0x3E, 0x07,
+    0x7A, 0x25, 0xD9, 0xA4, 0x85, 0x70, 0x94, 0x97, 0x30, 0xCB, 0x54, 0x1A,
+    0x8A, 0x92, 0x49, 0x93, 0xA2, 0xF7, 0x43, 0x71, 0x89, 0xA9, 0x95, 0x04,
+    0x6F, 0xD7, 0xC1, 0x2C, 0x4F, 0xAD, 0xDE, 0xBF, 0x25, 0xC2, 0xDE, 0xFC,
+    0x05, 0x58, 0x3B, 0x92, 0x1F, 0x0D, 0x41, 0x95, 0x23, 0xE9, 0xCF, 0x4E,
+    0x25, 0xD8, 0x0E, 0x8A, 0xB7, 0x9C, 0x9B, 0x71, 0x1B, 0x35, 0x97, 0xC6,
+    0x89, 0xA0, 0xB6, 0x49, 0x09, 0x8D, 0x16, 0x34, 0x80, 0x3A, 0xA7, 0xAC,
+    0x5F, 0xE0, 0xB9, 0x9C, 0x1D, 0xE8, 0xDF, 0xAB, 0x1F, 0x8B, 0xC5, 0xE2,
+};
+
+static const uint8_t xsm3_kat_usbdsec_acr[32] = {
+    0x9C, 0x73, 0xA8, 0x27, 0x71, 0x4C, 0x1B, 0xD1, 0x91, 0xB5, 0x20, 0x92,
+    0xE1, 0x5D, 0xF4, 0x6E, 0x4C, 0xD7, 0xD9, 0x70, 0x57, 0x39, 0x6B, 0xDF,
+    0x4C, 0x5C, 0x37, 0x77, 0xF9, 0x49, 0xAF, 0xEF,
+};
+
+static const uint8_t xsm3_kat_handshake[416] = {
+    0x49, 0x4C, 0x00, 0x00, 0x28, 0x3A, 0xC6, 0x5D, 0x07, 0xA8, 0x71, 0x94,
+    0xB3, 0x1E, 0x2E, 0x6E, 0x44, 0x9E, 0x14, 0x25, 0x88, 0x98, 0x0A, 0x9A,
+    0x61, 0x4B, 0x5A, 0x03, 0x54, 0xD4, 0x83, 0x89, 0x4E, 0xC0, 0x94, 0x4D,
+    0xE2, 0x3D, 0xE9, 0xEF, 0x30, 0xAE, 0x18, 0x13, 0xCD, 0x42, 0x00, 0x00,
+    0x49, 0x4C, 0x00, 0x00, 0x10, 0x37, 0x44, 0xEB, 0x19, 0x3E, 0x97, 0x1F,
+    0xA5, 0x1D, 0x3A, 0x10, 0x11, 0x4E, 0x66, 0xAC, 0x26, 0x16, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x53, 0x74, 0x70, 0x33, 0x0B, 0xAC, 0xF8, 0x9B, 0x49, 0x4C, 0x00, 0x00,
+    0x28, 0x87, 0xAE, 0xF0, 0xE7, 0xDE, 0xCB, 0x33, 0x18, 0x8C, 0xE3, 0x9A,
+    0x20, 0xD4, 0xF3, 0x41, 0x52, 0x40, 0x5E, 0xAC, 0xE0, 0xDF, 0x36, 0x66,
+    0x60, 0x84, 0x9E, 0xEA, 0x8A, 0x84, 0xB9, 0xB8, 0x2A, 0xC6, 0x4C, 0x2D,
+    0x71, 0xBC, 0x84, 0x50, 0xDF, 0xE8, 0x00, 0x00, 0x49, 0x4C, 0x00, 0x00,
+    0x10, 0xA6, 0xF5, 0x50, 0xBE, 0xC1, 0xD9, 0x89, 0x24, 0x84, 0xCA, 0x23,
+    0x96, 0xE2, 0x8F, 0x36, 0x82, 0x2A, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xC4, 0xBB, 0x3C, 0x72,
+    0x8B, 0xAA, 0x7D, 0xED, 0x49, 0x4C, 0x00, 0x00, 0x28, 0x8E, 0x44, 0xB4,
+    0xBF, 0x0A, 0x9A, 0x96, 0x48, 0xA7, 0xCD, 0x89, 0x5D, 0x60, 0x8A, 0xF7,
+    0x4F, 0x7D, 0xD3, 0xE6, 0x1D, 0xA0, 0xAC, 0xA1, 0xC8, 0xD1, 0x70, 0x03,
+    0x97, 0xDB, 0x2A, 0x80, 0x70, 0x84, 0x25, 0x8E, 0x49, 0x58, 0xA2, 0xEB,
+    0xF6, 0xE6, 0x00, 0x00, 0x49, 0x4C, 0x00, 0x00, 0x10, 0xB7, 0x34, 0x5D,
+    0x0C, 0xD4, 0x14, 0xFC, 0xBE, 0xF8, 0x58, 0x40, 0x75, 0x42, 0x13, 0xE7,
+    0x45, 0x36, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0xC3, 0xBD, 0x7D, 0x04, 0x95, 0x53, 0xE9, 0x3F,
+    0x49, 0x4C, 0x00, 0x00, 0x28, 0x8B, 0x6E, 0x25, 0xB9, 0x95, 0x40, 0x54,
+    0x1B, 0x21, 0x22, 0x71, 0x91, 0xAA, 0xF2, 0x91, 0xB3, 0x68, 0xB2, 0xF5,
+    0x8A, 0xFB, 0xF9, 0xFC, 0xB2, 0x58, 0x35, 0xAB, 0xD3, 0xB9, 0xC7, 0x31,
+    0x50, 0x4C, 0x91, 0xBB, 0xE0, 0xE0, 0x54, 0xE9, 0x22, 0x60, 0x00, 0x00,
+    0x49, 0x4C, 0x00, 0x00, 0x10, 0xAC, 0xD1, 0xF4, 0xCB, 0x96, 0xC2, 0x94,
+    0x46, 0x5A, 0x26, 0xA6, 0xCB, 0x3F, 0xD9, 0x33, 0x0A, 0x0A, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+    0xD2, 0xDB, 0xCC, 0x6E, 0x57, 0xF5, 0xFF, 0x87,
+};
+
+static const struct {
+    const char* name;
+    const uint8_t* data;
+    size_t size;
+} xsm3_kat_vectors[] = {
+    {"des_parity", xsm3_kat_des_parity, sizeof(xsm3_kat_des_parity)},
+    {"des_ecb", xsm3_kat_des_ecb, sizeof(xsm3_kat_des_ecb)},
+    {"des3_ecb", xsm3_kat_des3_ecb, sizeof(xsm3_kat_des3_ecb)},
+    {"des3_cbc", xsm3_kat_des3_cbc, sizeof(xsm3_kat_des3_cbc)},
+    {"sha", xsm3_kat_sha, sizeof(xsm3_kat_sha)},
+    {"sha_stream", xsm3_kat_sha_stream, sizeof(xsm3_kat_sha_stream)},
+    {"parve_ecb", xsm3_kat_parve_ecb, sizeof(xsm3_kat_parve_ecb)},
+    {"parve_cbc_mac", xsm3_kat_parve_cbc_mac, sizeof(xsm3_kat_parve_cbc_mac)},
+    {"chain_and_sum", xsm3_kat_chain_and_sum, sizeof(xsm3_kat_chain_and_sum)},
+    {"usbdsec_crypt", xsm3_kat_usbdsec_crypt, sizeof(xsm3_kat_usbdsec_crypt)},
+    {"usbdsec_mac", xsm3_kat_usbdsec_mac, sizeof(xsm3_kat_usbdsec_mac)},
+    {"usbdsec_acr", xsm3_kat_usbdsec_acr, sizeof(xsm3_kat_usbdsec_acr)},
+    {"handshake", xsm3_kat_handshake, sizeof(xsm3_kat_handshake)},
+};
@@ -0,0 +1,167 @@
+#include <pthread.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "excrypt.h"
+#include "usbdsec.h"
+#include "xsm3.h"
+#include "xsm3_kat_cases.h"
+#include "xsm3_kat_vectors.h"
+#include "xsm3_test_util.h"
+
+#define XSM3_TEST_THREADS 8
+#define XSM3_TEST_THREAD_HANDSHAKES 500
+
+static int failures = 0;
+
+static void check(bool ok, const char* name) {
+    printf("%s %s\n", ok ? "ok  " : "FAIL", name);
+    if (!ok) {
+        failures++;
+    }
+}
+
+static bool hex_equal(const uint8_t* data, const char* hex) {
+    for (size_t i = 0; hex[i * 2]; i++) {
+        unsigned int byte;
+        if (sscanf(hex + i * 2, "%2x", &byte) != 1 || data[i] != byte) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void test_vectors(void) {
+    static uint8_t out[XSM3_KAT_OUTPUT_MAX];
+    check(xsm3_kat_case_count == sizeof(xsm3_kat_vectors) / sizeof(xsm3_kat_vectors[0]),
+          "vector table matches the cases");
+    for (size_t i = 0; i < xsm3_kat_case_count; i++) {
+        size_t size = xsm3_kat_cases[i].run(out);
+        check(strcmp(xsm3_kat_cases[i].name, xsm3_kat_vectors[i].name) == 0 &&
+                  size == xsm3_kat_vectors[i].size &&
+                  memcmp(out, xsm3_kat_vectors[i].data, size) == 0,
+              xsm3_kat_cases[i].name);
+    }
+}
+
+// FIPS 180 examples
+static void test_sha_fips(void) {
+    static uint8_t million[1000000];
+    uint8_t digest[0x14];
+    const char* two_block = "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq";
+
+    ExCryptSha((const uint8_t*)"abc", 3, NULL, 0, NULL, 0, digest, sizeof(digest));
+    check(hex_equal(digest, "a9993e364706816aba3e25717850c26c9cd0d89d"), "sha fips abc");
+
+    ExCryptSha(NULL, 0, NULL, 0, NULL, 0, digest, sizeof(digest));
+    check(hex_equal(digest, "da39a3ee5e6b4b0d3255bfef95601890afd80709"), "sha fips empty");
+
+    ExCryptSha((const uint8_t*)two_block, strlen(two_block), NULL, 0, NULL, 0, digest, sizeof(digest));
+    check(hex_equal(digest, "84983e441c3bd26ebaae4aa1f95129e5e54670f1"), "sha fips two blocks");
+
+    memset(million, 'a', sizeof(million));
+    EXCRYPT_SHA_STATE state;
+    ExCryptShaInit(&state);
+    // Odd chunks, so most updates start and end mid-block
+    for (uint32_t offset = 0; offset < sizeof(million); offset += 999) {
+        uint32_t length = sizeof(million) - offset;
+        ExCryptShaUpdate(&state, million + offset, length < 999 ? length : 999);
+    }
+    ExCryptShaFinal(&state, digest, sizeof(digest));
+    check(hex_equal(digest, "34aa973cd4c4daa4f61eeb2bdbad27316534016f"), "sha fips million a");
+}
+
+// FIPS 81 example
+static void test_des_fips(void) {
+    const uint8_t key[8] = {0x01, 0x23, 0x45, 0x67, 0x89, 0xAB, 0xCD, 0xEF};
+    const uint8_t plain[8] = {'N', 'o', 'w', ' ', 'i', 's', ' ', 't'};
+    uint8_t cipher[8];
+    uint8_t back[8];
+    EXCRYPT_DES_STATE state;
+    ExCryptDesKey(&state, key);
+    ExCryptDesEcb(&state, plain, cipher, 1);
+    ExCryptDesEcb(&state, cipher, back, 0);
+    check(hex_equal(cipher, "3fa40e8a984d4815") && memcmp(back, plain, 8) == 0, "des fips 81");
+}
+
+// Same handshake as the handshake vectors, on a context instead of the shared state
+static bool context_handshake(Xsm3Context* ctx, Xsm3KeyCache* cache, uint32_t seed) {
+    uint8_t serial[0x0C];
+    uint8_t init_packet[0x22];
+    uint8_t verify_packet[0x16];
+    uint8_t out[XSM3_KAT_HANDSHAKE_SIZE];
+    xsm3_test_serial(serial, seed);
+    xsm3_test_init_packet(init_packet, seed * 3 + 1);
+    xsm3_test_verify_packet(verify_packet, seed * 3 + 2);
+
+    xsm3_context_init(ctx);
+    xsm3_context_set_key_cache(ctx, cache);
+    xsm3_context_set_vid_pid(ctx, serial, XSM3_KAT_VID, XSM3_KAT_PID);
+    xsm3_context_set_identification_data(ctx, ctx->id_data);
+    xsm3_test_seed(seed);
+    xsm3_context_do_challenge_init(ctx, init_packet);
+    memcpy(out, ctx->challenge_response, 0x30);
+    xsm3_context_do_challenge_verify(ctx, verify_packet);
+    memcpy(out + 0x30, ctx->challenge_response, 0x30);
+    memcpy(out + 0x60, ctx->console_id, 0x08);
+
+    const uint8_t* expected = xsm3_kat_handshake + (seed - 1) * XSM3_KAT_HANDSHAKE_SIZE;
+    return memcmp(out, expected, sizeof(out)) == 0;
+}
+
+static void test_context(void) {
+    Xsm3Context ctx;
+    Xsm3KeyCache cache;
+    bool ok = true;
+    for (uint32_t seed = 1; seed <= XSM3_KAT_HANDSHAKES; seed++) {
+        ok &= context_handshake(&ctx, NULL, seed);
+    }
+    check(ok, "context handshake");
+
+    // Second round hits the cache for every console
+    xsm3_key_cache_init(&cache);
+    ok = true;
+    for (int round = 0; round < 2; round++) {
+        for (uint32_t seed = 1; seed <= XSM3_KAT_HANDSHAKES; seed++) {
+            ok &= context_handshake(&ctx, &cache, seed);
+        }
+    }
+    check(ok && cache.dirty, "context handshake with key cache");
+}
+
+static void* thread_handshakes(void* arg) {
+    uint32_t first = (uint32_t)(uintptr_t)arg;
+    Xsm3Context ctx;
+    Xsm3KeyCache cache;
+    xsm3_key_cache_init(&cache);
+    uintptr_t failed = 0;
+    for (uint32_t i = 0; i < XSM3_TEST_THREAD_HANDSHAKES; i++) {
+        uint32_t seed = (first + i) % XSM3_KAT_HANDSHAKES + 1;
+        failed += !context_handshake(&ctx, (i & 1) ? &cache : NULL, seed);
+    }
+    return (void*)failed;
+}
+
+static void test_parallel(void) {
+    pthread_t threads[XSM3_TEST_THREADS];
+    uintptr_t failed = 0;
+    for (uintptr_t i = 0; i < XSM3_TEST_THREADS; i++) {
+        pthread_create(&threads[i], NULL, thread_handshakes, (void*)i);
+    }
+    for (size_t i = 0; i < XSM3_TEST_THREADS; i++) {
+        void* result;
+        pthread_join(threads[i], &result);
+        failed += (uintptr_t)result;
+    }
+    check(failed == 0, "parallel context handshakes");
+}
+
+int main(void) {
+    test_vectors();
+    test_sha_fips();
+    test_des_fips();
+    test_context();
+    test_parallel();
+    printf("%d failed\n", failures);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,57 @@
+#include "xsm3_test_util.h"
+#include "furi_hal_random.h"
+
+#include <string.h>
+
+static _Thread_local uint32_t xsm3_test_state = 1;
+
+static uint32_t xsm3_test_next(uint32_t* state) {
+    // xorshift32, never reaches 0 from a non-zero state
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+void xsm3_test_seed(uint32_t seed) {
+    xsm3_test_state = seed ? seed : 1;
+}
+
+uint32_t furi_hal_random_get(void) {
+    return xsm3_test_next(&xsm3_test_state);
+}
+
+void xsm3_test_fill(uint8_t* out, size_t size, uint32_t seed) {
+    uint32_t state = seed * 2654435761u + 1;
+    for (size_t i = 0; i < size; i++) {
+        out[i] = xsm3_test_next(&state) >> 24;
+    }
+}
+
+static void xsm3_test_packet(uint8_t* packet, size_t size, uint8_t magic, uint32_t seed) {
+    memset(packet, 0, size);
+    packet[0] = 0x09;
+    packet[1] = magic;
+    // payload runs from 5 to the checksum in the last byte
+    packet[4] = size - 6;
+    xsm3_test_fill(packet + 5, size - 6, seed);
+    uint8_t checksum = 0;
+    for (size_t i = 5; i < size - 1; i++) {
+        checksum ^= packet[i];
+    }
+    packet[size - 1] = checksum;
+}
+
+void xsm3_test_init_packet(uint8_t packet[0x22], uint32_t seed) {
+    xsm3_test_packet(packet, 0x22, 0x40, seed);
+}
+
+void xsm3_test_verify_packet(uint8_t packet[0x16], uint32_t seed) {
+    xsm3_test_packet(packet, 0x16, 0x4C, seed);
+}
+
+void xsm3_test_serial(uint8_t serial[0x0C], uint32_t seed) {
+    xsm3_test_fill(serial, 0x0C, seed);
+}
@@ -0,0 +1,16 @@
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Per thread and deterministic, so handshakes can be replayed against the vectors
+void xsm3_test_seed(uint32_t seed);
+
+// Fills out with bytes that only depend on seed
+void xsm3_test_fill(uint8_t* out, size_t size, uint32_t seed);
+
+// Challenge packets with a valid header and checksum around seeded payload bytes
+void xsm3_test_init_packet(uint8_t packet[0x22], uint32_t seed);
+void xsm3_test_verify_packet(uint8_t packet[0x16], uint32_t seed);
+
+void xsm3_test_serial(uint8_t serial[0x0C], uint32_t seed);
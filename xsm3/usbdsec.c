@@ -21,8 +21,9 @@
 #include <string.h>
 #include <stdio.h>
 #include "excrypt.h"
+#include "usbdsec.h"
 
-static uint8_t UsbdSecSboxData[256] __attribute__ ((aligned(4))) = {
+static const uint8_t UsbdSecSboxData[256] __attribute__ ((aligned(4))) = {
 	0xB0, 0x3D, 0x9B, 0x70, 0xF3, 0xC7, 0x80, 0x60,
 	0x73, 0x9F, 0x6C, 0xC0, 0xF1, 0x3D, 0xBB, 0x40,
 	0xB3, 0xC8, 0x37, 0x14, 0xDF, 0x49, 0xDA, 0xD4,
@@ -57,7 +58,7 @@ static uint8_t UsbdSecSboxData[256] __attribute__ ((aligned(4))) = {
 	0xE3, 0x0D, 0xAE, 0x7E, 0x33, 0x69, 0x80, 0x40
 };
 
-static uint8_t UsbdSecPlainTextData[128] __attribute__ ((aligned(4))) = {
+static const uint8_t UsbdSecPlainTextData[128] __attribute__ ((aligned(4))) = {
 	0xD1, 0xD2, 0xF2, 0x80, 0x6E, 0xBA, 0x0C, 0xC0,
 	0xB6, 0xC4, 0xC9, 0xD8, 0x61, 0x75, 0x1D, 0x1A,
 	0x3F, 0x95, 0x58, 0xBE, 0xD8, 0x0D, 0xE2, 0xC0,
@@ -76,25 +77,29 @@ static uint8_t UsbdSecPlainTextData[128] __attribute__ ((aligned(4))) = {
 	0x66, 0xFA, 0x47, 0x55, 0x6C, 0x8D, 0x40, 0x08
 };
 
-void UsbdSecXSM3AuthenticationCrypt(const uint8_t *key, const uint8_t *input, size_t length, uint8_t *output, uint8_t encrypt) {
-	EXCRYPT_DES3_STATE des;
-	uint64_t sk[3];
-	uint8_t iv[8];
+void UsbdSecPrepareKey(UsbdSecKey *prepared, const uint8_t *key) {
+	uint64_t sk[2];
 
-	// clear local variables
-    memset(iv, 0, sizeof(iv));
 	// run parity on the key
 	ExCryptDesParity(key, 0x10, (uint8_t *)sk);
-	sk[2] = sk[0];
-	// set the key in the state and run triple-des cbc en/decryption on it
-	ExCryptDes3Key(&des, sk);
-	ExCryptDes3Cbc(&des, input, length, output, iv, encrypt);
+	// 2-key triple-des, the third schedule is the same as the first
+	ExCryptDesKey(&prepared->des3.des_state[0], (uint8_t *)&sk[0]);
+	ExCryptDesKey(&prepared->des3.des_state[1], (uint8_t *)&sk[1]);
+	memcpy(&prepared->des3.des_state[2], &prepared->des3.des_state[0], sizeof(EXCRYPT_DES_STATE));
 }
 
-void UsbdSecXSM3AuthenticationMac(const uint8_t *key, uint8_t *salt, uint8_t *input, size_t length, uint8_t *output) {
-	EXCRYPT_DES3_STATE des3;
-	EXCRYPT_DES_STATE des;
-	uint64_t sk[3];
+void UsbdSecXSM3AuthenticationCryptKey(const UsbdSecKey *key, const uint8_t *input, size_t length, uint8_t *output, uint8_t encrypt) {
+	uint8_t iv[8];
+
+	// clear local variables
+	memset(iv, 0, sizeof(iv));
+	// run triple-des cbc en/decryption
+	ExCryptDes3Cbc(&key->des3, input, length, output, iv, encrypt);
+}
+
+void UsbdSecXSM3AuthenticationMacKey(const UsbdSecKey *key, uint8_t *salt, uint8_t *input, size_t length, uint8_t *output) {
+	// single des with the first key, which is also the first triple-des stage
+	const EXCRYPT_DES_STATE *des = &key->des3.des_state[0];
 	uint8_t iv[8];
 	uint8_t temp[8];
 	uint64_t input_temp;
@@ -103,36 +108,44 @@ void UsbdSecXSM3AuthenticationMac(const uint8_t *key, uint8_t *salt, uint8_t *in
 	// clear iv + temp value of stack junk
 	memset(iv, 0, sizeof(iv));
 	memset(temp, 0, sizeof(temp));
-	// run parity on the key
-	ExCryptDesParity(key, 0x10, (uint8_t *)sk);
-	sk[2] = sk[0];
-	// set the key in our initial des state
-	ExCryptDesKey(&des, (uint8_t *)&sk[0]);
 	// if we have a salt, encrypt it into the temp value
 	if (salt) {
 		memcpy(&input_temp, salt, sizeof(input_temp));
 		input_temp = SWAP64(SWAP64(input_temp) + 1);
 		memcpy(salt, &input_temp, sizeof(input_temp)); // no idea what this does
-		ExCryptDesEcb(&des, salt, temp, 1);
+		ExCryptDesEcb(des, salt, temp, 1);
 	}
 	// for every 8 byte input block, xor the temp value with it and encrypt over itself
 	for (i = 0; i < length; i += 8) {
 		memcpy(&input_temp, input+i, sizeof(input_temp));
 		*(uint64_t *)temp ^= input_temp;
 		
-		ExCryptDesEcb(&des, temp, temp, 1);
+		ExCryptDesEcb(des, temp, temp, 1);
 	}
 	// xor the highest bit of the temp value
 	temp[0] ^= 0x80;
-	// set the key and perform the final triple-des encryption
-	ExCryptDes3Key(&des3, sk);
-	ExCryptDes3Cbc(&des3, temp, 8, output, iv, 1);
+	// perform the final triple-des encryption
+	ExCryptDes3Cbc(&key->des3, temp, 8, output, iv, 1);
 	// real kernel does the following, but the above works:
 	// XeCryptDesEcb(des_state_1, temp, temp, 1);
 	// XeCryptDesEcb(des_state_2, temp, temp, 0);
 	// XeCryptDesEcb(des_state_1, temp, output, 1);
 }
 
+void UsbdSecXSM3AuthenticationCrypt(const uint8_t *key, const uint8_t *input, size_t length, uint8_t *output, uint8_t encrypt) {
+	UsbdSecKey prepared;
+
+	UsbdSecPrepareKey(&prepared, key);
+	UsbdSecXSM3AuthenticationCryptKey(&prepared, input, length, output, encrypt);
+}
+
+void UsbdSecXSM3AuthenticationMac(const uint8_t *key, uint8_t *salt, uint8_t *input, size_t length, uint8_t *output) {
+	UsbdSecKey prepared;
+
+	UsbdSecPrepareKey(&prepared, key);
+	UsbdSecXSM3AuthenticationMacKey(&prepared, salt, input, length, output);
+}
+
 void UsbdSecXSMAuthenticationAcr(const uint8_t *console_id, const uint8_t *input, const uint8_t *key, uint8_t *output) {
 	uint8_t block[8];
 	uint8_t iv[8];
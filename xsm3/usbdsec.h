@@ -21,9 +21,20 @@
 #define USBDSEC_H_
 
 #include <stddef.h>
+#include "excrypt.h"
+
+// A 2-key 3DES key with its schedules expanded, for keys used more than once.
+// The third key is the first one again, so its schedule is a copy.
+typedef struct {
+	EXCRYPT_DES3_STATE des3;
+} UsbdSecKey;
+
+void UsbdSecPrepareKey(UsbdSecKey *prepared, const uint8_t *key);
+void UsbdSecXSM3AuthenticationCryptKey(const UsbdSecKey *key, const uint8_t *input, size_t length, uint8_t *output, uint8_t encrypt);
+void UsbdSecXSM3AuthenticationMacKey(const UsbdSecKey *key, uint8_t *salt, uint8_t *input, size_t length, uint8_t *output);
 
 void UsbdSecXSM3AuthenticationCrypt(const uint8_t *key, const uint8_t *input, size_t length, uint8_t *output, uint8_t encrypt);
-void UsbdSecXSM3AuthenticationMac(const uint8_t *key, const uint8_t *salt, uint8_t *input, size_t length, uint8_t *output);
+void UsbdSecXSM3AuthenticationMac(const uint8_t *key, uint8_t *salt, uint8_t *input, size_t length, uint8_t *output);
 void UsbdSecXSMAuthenticationAcr(const uint8_t *console_id, const uint8_t *input, const uint8_t *key, uint8_t *output);
 
 #endif // USBDSEC_H_
\ No newline at end of file
@@ -37,7 +37,7 @@
 #endif  // XSM3_NO_DEBUGGING
 
 // constant variables
-uint8_t xsm3_id_data_ms_controller[0x1D] = {
+static const uint8_t xsm3_id_data_template[0x1D] = {
     0x49, 0x4B, 0x00, 0x00, 0x17, 0x41, 0x41, 0x41,
     0x41, 0x41, 0x41, 0x41, 0x41, 0x41, 0x41, 0x41,
     0x00, 0x00, 0x80, 0x02, 0x09, 0x12, 0x82, 0x28,
@@ -60,45 +60,6 @@ static const uint8_t xsm3_root_key_0x24[0x10] = {
     0x66, 0x62, 0x1A, 0x78, 0xF8, 0x60, 0x9C, 0x8A,
     0x26, 0x9A, 0x04, 0xAE, 0xD8, 0x5C, 0x1E, 0xC8};
 
-// response to give to the given challenge command
-uint8_t xsm3_challenge_response[0x30];
-// console id fetched from challenge init packet
-uint8_t xsm3_console_id[0x8];
-
-// buffer to store the first key fetched from the KV (0x23)
-static uint8_t xsm3_kv_2des_key_1[0x10];
-// buffer to store the second key fetched from the KV (0x24)
-static uint8_t xsm3_kv_2des_key_2[0x10];
-
-// temporary buffer for decrypting packets
-static uint8_t xsm3_decryption_buffer[0x30];
-// identification data for the current device
-static uint8_t xsm3_identification_data[0x20];
-// random data sent from the console during the challenge init stage
-static uint8_t xsm3_random_console_data[0x10];
-static uint8_t xsm3_random_console_data_enc[0x10];
-static uint8_t xsm3_random_console_data_swap[0x10];
-static uint8_t xsm3_random_console_data_swap_enc[0x10];
-// random data set by the controller during the challenge init stage
-static uint8_t xsm3_random_controller_data[0x10];
-// hash of the decrypted data sent by the controller during challenge init
-static uint8_t xsm3_challenge_init_hash[0x14];
-void xsm3_initialise_state() {
-    // set all variables to all zeroes
-    memset(xsm3_challenge_response, 0, sizeof(xsm3_challenge_response));
-    memset(xsm3_console_id, 0, sizeof(xsm3_console_id));
-    memset(xsm3_kv_2des_key_1, 0, sizeof(xsm3_kv_2des_key_1));
-    memset(xsm3_kv_2des_key_2, 0, sizeof(xsm3_kv_2des_key_2));
-    memset(xsm3_decryption_buffer, 0, sizeof(xsm3_decryption_buffer));
-    memset(xsm3_identification_data, 0, sizeof(xsm3_identification_data));
-    memset(xsm3_random_console_data, 0, sizeof(xsm3_random_console_data));
-    memset(xsm3_random_console_data_enc, 0, sizeof(xsm3_random_console_data_enc));
-    memset(xsm3_random_console_data_swap, 0, sizeof(xsm3_random_console_data_swap));
-    memset(xsm3_random_console_data_swap_enc, 0, sizeof(xsm3_random_console_data_swap_enc));
-    memset(xsm3_random_controller_data, 0, sizeof(xsm3_random_controller_data));
-    memset(xsm3_challenge_init_hash, 0, sizeof(xsm3_challenge_init_hash));
-}
-
 static uint8_t xsm3_calculate_checksum(const uint8_t* packet) {
     // packet length in header doesn't include the header itself
     uint8_t packet_length = packet[0x4] + 0x5;
@@ -112,26 +73,90 @@ static uint8_t xsm3_calculate_checksum(const uint8_t* packet) {
     return checksum;
 }
 
-void xsm3_set_vid_pid(const uint8_t serial[0x0C], uint16_t vid, uint16_t pid) {
-    memcpy(xsm3_id_data_ms_controller + 6, serial, 0x0C);
-    uint8_t* id_data = xsm3_id_data_ms_controller;
+static bool xsm3_verify_checksum(const uint8_t* packet) {
+    // packet length in header doesn't include the header itself
+    uint8_t packet_length = packet[0x4] + 0x5;
+    // last byte of the packet is the checksum
+    return (xsm3_calculate_checksum(packet) == packet[packet_length]);
+}
+
+static void xsm3_write_vid_pid(uint8_t id_packet[0x1D], const uint8_t serial[0x0C], uint16_t vid, uint16_t pid) {
+    memcpy(id_packet + 6, serial, 0x0C);
+    uint8_t* id_data = id_packet;
     // skip over the packet header
     id_data += 0x5;
     // vendor ID
     memcpy(id_data + 0xf, &vid, sizeof(unsigned short));
     // product ID
     memcpy(id_data + 0x11, &pid, sizeof(unsigned short));
-    xsm3_id_data_ms_controller[0x1C] = xsm3_calculate_checksum(xsm3_id_data_ms_controller);
+    id_packet[0x1C] = xsm3_calculate_checksum(id_packet);
 }
 
-static bool xsm3_verify_checksum(const uint8_t* packet) {
-    // packet length in header doesn't include the header itself
-    uint8_t packet_length = packet[0x4] + 0x5;
-    // last byte of the packet is the checksum
-    return (xsm3_calculate_checksum(packet) == packet[packet_length]);
+// everything but the identification packet
+static void xsm3_clear_state(Xsm3Context* ctx) {
+    memset(ctx->challenge_response, 0, sizeof(ctx->challenge_response));
+    memset(ctx->console_id, 0, sizeof(ctx->console_id));
+    memset(ctx->kv_2des_key_1, 0, sizeof(ctx->kv_2des_key_1));
+    memset(ctx->kv_2des_key_2, 0, sizeof(ctx->kv_2des_key_2));
+    memset(ctx->decryption_buffer, 0, sizeof(ctx->decryption_buffer));
+    memset(ctx->identification_data, 0, sizeof(ctx->identification_data));
+    memset(ctx->random_console_data, 0, sizeof(ctx->random_console_data));
+    memset(ctx->random_console_data_enc, 0, sizeof(ctx->random_console_data_enc));
+    memset(ctx->random_console_data_swap, 0, sizeof(ctx->random_console_data_swap));
+    memset(ctx->random_console_data_swap_enc, 0, sizeof(ctx->random_console_data_swap_enc));
+    memset(ctx->random_controller_data, 0, sizeof(ctx->random_controller_data));
+    memset(ctx->challenge_init_hash, 0, sizeof(ctx->challenge_init_hash));
+    memset(&ctx->session_crypt_key, 0, sizeof(ctx->session_crypt_key));
+    memset(&ctx->session_mac_key, 0, sizeof(ctx->session_mac_key));
 }
 
-void xsm3_set_identification_data(const uint8_t id_data[0x1D]) {
+void xsm3_context_init(Xsm3Context* ctx) {
+    xsm3_clear_state(ctx);
+    memcpy(ctx->id_data, xsm3_id_data_template, sizeof(ctx->id_data));
+    ctx->key_cache = NULL;
+}
+
+void xsm3_context_set_key_cache(Xsm3Context* ctx, Xsm3KeyCache* cache) {
+    ctx->key_cache = cache;
+}
+
+void xsm3_key_cache_init(Xsm3KeyCache* cache) {
+    memset(cache, 0, sizeof(Xsm3KeyCache));
+}
+
+static bool xsm3_key_cache_lookup(Xsm3KeyCache* cache, const uint8_t console_id[0x8], uint8_t key_1[0x10], uint8_t key_2[0x10]) {
+    for (size_t i = 0; i < XSM3_KEY_CACHE_SIZE; i++) {
+        Xsm3KeyCacheEntry* entry = &cache->entries[i];
+        if (entry->last_used && memcmp(entry->console_id, console_id, 0x8) == 0) {
+            memcpy(key_1, entry->kv_2des_key_1, 0x10);
+            memcpy(key_2, entry->kv_2des_key_2, 0x10);
+            entry->last_used = ++cache->clock;
+            return true;
+        }
+    }
+    return false;
+}
+
+static void xsm3_key_cache_insert(Xsm3KeyCache* cache, const uint8_t console_id[0x8], const uint8_t key_1[0x10], const uint8_t key_2[0x10]) {
+    // empty slots have last_used 0, so they go first
+    Xsm3KeyCacheEntry* entry = &cache->entries[0];
+    for (size_t i = 1; i < XSM3_KEY_CACHE_SIZE; i++) {
+        if (cache->entries[i].last_used < entry->last_used) {
+            entry = &cache->entries[i];
+        }
+    }
+    memcpy(entry->console_id, console_id, 0x8);
+    memcpy(entry->kv_2des_key_1, key_1, 0x10);
+    memcpy(entry->kv_2des_key_2, key_2, 0x10);
+    entry->last_used = ++cache->clock;
+    cache->dirty = true;
+}
+
+void xsm3_context_set_vid_pid(Xsm3Context* ctx, const uint8_t serial[0x0C], uint16_t vid, uint16_t pid) {
+    xsm3_write_vid_pid(ctx->id_data, serial, vid, pid);
+}
+
+void xsm3_context_set_identification_data(Xsm3Context* ctx, const uint8_t id_data[0x1D]) {
     // validate the checksum
     if (!xsm3_verify_checksum(id_data)) {
         XSM3_printf("[ Checksum failed when setting identification data! ]\n");
@@ -140,32 +165,38 @@ void xsm3_set_identification_data(const uint8_t id_data[0x1D]) {
     // skip over the packet header
     id_data += 0x5;
 
-    // prepare the xsm3_identification_data buffer
+    // prepare the identification_data buffer
 
     // contains serial number (len: 0xC), unknown (len: 0x2) and the "category node" to use (len: 0x1)
-    memcpy(xsm3_identification_data, id_data, 0xF);
+    memcpy(ctx->identification_data, id_data, 0xF);
     // vendor ID
-    memcpy(xsm3_identification_data + 0x10, id_data + 0xF, sizeof(unsigned short));
+    memcpy(ctx->identification_data + 0x10, id_data + 0xF, sizeof(unsigned short));
     // product ID
-    memcpy(xsm3_identification_data + 0x12, id_data + 0x11, sizeof(unsigned short));
+    memcpy(ctx->identification_data + 0x12, id_data + 0x11, sizeof(unsigned short));
     // unknown
-    memcpy(xsm3_identification_data + 0x14, id_data + 0x13, sizeof(unsigned char));
+    memcpy(ctx->identification_data + 0x14, id_data + 0x13, sizeof(unsigned char));
     // unknown
-    memcpy(xsm3_identification_data + 0x15, id_data + 0x16, sizeof(unsigned char));
+    memcpy(ctx->identification_data + 0x15, id_data + 0x16, sizeof(unsigned char));
     // unknown
-    memcpy(xsm3_identification_data + 0x16, id_data + 0x14, sizeof(unsigned short));
+    memcpy(ctx->identification_data + 0x16, id_data + 0x14, sizeof(unsigned short));
 }
 
-void xsm3_generate_kv_keys(const uint8_t console_id[0x8]) {
+static void xsm3_generate_kv_keys(Xsm3Context* ctx, const uint8_t console_id[0x8]) {
+    if (ctx->key_cache && xsm3_key_cache_lookup(ctx->key_cache, console_id, ctx->kv_2des_key_1, ctx->kv_2des_key_2)) {
+        return;
+    }
     // make a sha-1 hash of the console id
     uint8_t console_id_hash[0x14];
     ExCryptSha(console_id, 0x8, NULL, 0, NULL, 0, console_id_hash, 0x14);
     // encrypt it with the root keys for 1st party controllers
-    UsbdSecXSM3AuthenticationCrypt(xsm3_root_key_0x23, console_id_hash, 0x10, xsm3_kv_2des_key_1, 1);
-    UsbdSecXSM3AuthenticationCrypt(xsm3_root_key_0x24, console_id_hash + 0x4, 0x10, xsm3_kv_2des_key_2, 1);
+    UsbdSecXSM3AuthenticationCrypt(xsm3_root_key_0x23, console_id_hash, 0x10, ctx->kv_2des_key_1, 1);
+    UsbdSecXSM3AuthenticationCrypt(xsm3_root_key_0x24, console_id_hash + 0x4, 0x10, ctx->kv_2des_key_2, 1);
+    if (ctx->key_cache) {
+        xsm3_key_cache_insert(ctx->key_cache, console_id, ctx->kv_2des_key_1, ctx->kv_2des_key_2);
+    }
 }
 
-void xsm3_do_challenge_init(uint8_t challenge_packet[0x22]) {
+void xsm3_context_do_challenge_init(Xsm3Context* ctx, const uint8_t challenge_packet[0x22]) {
     uint8_t incoming_packet_mac[0x8];
     uint8_t response_packet_mac[0x8];
     int i = 0;
@@ -176,59 +207,62 @@ void xsm3_do_challenge_init(uint8_t challenge_packet[0x22]) {
     }
 
     // decrypt the packet content using the static key from the keyvault
-    UsbdSecXSM3AuthenticationCrypt(xsm3_key_0x1D, challenge_packet + 0x5, 0x18, xsm3_decryption_buffer, 0);
+    UsbdSecXSM3AuthenticationCrypt(xsm3_key_0x1D, challenge_packet + 0x5, 0x18, ctx->decryption_buffer, 0);
     // first 0x10 bytes are random data
-    memcpy(xsm3_random_console_data, xsm3_decryption_buffer, 0x10);
+    memcpy(ctx->random_console_data, ctx->decryption_buffer, 0x10);
     // next 0x8 bytes are from the console certificate
-    memcpy(xsm3_console_id, xsm3_decryption_buffer + 0x10, 0x8);
+    memcpy(ctx->console_id, ctx->decryption_buffer + 0x10, 0x8);
     // last 4 bytes of the packet are the last 4 bytes of the MAC
-    UsbdSecXSM3AuthenticationMac(xsm3_key_0x1E, NULL, challenge_packet + 5, 0x18, incoming_packet_mac);
+    UsbdSecXSM3AuthenticationMac(xsm3_key_0x1E, NULL, (uint8_t*)challenge_packet + 5, 0x18, incoming_packet_mac);
     // validate the MAC
     if (memcmp(incoming_packet_mac + 4, challenge_packet + 0x5 + 0x18, 0x4) != 0) {
         XSM3_printf("[ MAC failed when validating challenge init! ]\n");
     }
-    xsm3_generate_kv_keys(xsm3_console_id);
+    xsm3_generate_kv_keys(ctx, ctx->console_id);
 
     // the random value is swapped at an 8 byte boundary
-    memcpy(xsm3_random_console_data_swap, xsm3_random_console_data + 0x8, 0x8);
-    memcpy(xsm3_random_console_data_swap + 0x8, xsm3_random_console_data, 0x8);
+    memcpy(ctx->random_console_data_swap, ctx->random_console_data + 0x8, 0x8);
+    memcpy(ctx->random_console_data_swap + 0x8, ctx->random_console_data, 0x8);
     // and then encrypted - the regular value encrypted with key 1, the swapped value encrypted with key 2
-    UsbdSecXSM3AuthenticationCrypt(xsm3_kv_2des_key_1, xsm3_random_console_data, 0x10, xsm3_random_console_data_enc, 1);
-    UsbdSecXSM3AuthenticationCrypt(xsm3_kv_2des_key_2, xsm3_random_console_data_swap, 0x10, xsm3_random_console_data_swap_enc, 1);
+    UsbdSecXSM3AuthenticationCrypt(ctx->kv_2des_key_1, ctx->random_console_data, 0x10, ctx->random_console_data_enc, 1);
+    UsbdSecXSM3AuthenticationCrypt(ctx->kv_2des_key_2, ctx->random_console_data_swap, 0x10, ctx->random_console_data_swap_enc, 1);
+    // both are used as keys again in verify, so expand their schedules once
+    UsbdSecPrepareKey(&ctx->session_crypt_key, ctx->random_console_data_enc);
+    UsbdSecPrepareKey(&ctx->session_mac_key, ctx->random_console_data_swap_enc);
 
     // generate random data
     for (i = 0; i < 0x10; i++) {
-        xsm3_random_controller_data[i] = furi_hal_random_get() & 0xFF;
+        ctx->random_controller_data[i] = furi_hal_random_get() & 0xFF;
     }
 
     // clear response buffers
-    memset(xsm3_challenge_response, 0, sizeof(xsm3_challenge_response));
-    memset(xsm3_decryption_buffer, 0, sizeof(xsm3_decryption_buffer));
+    memset(ctx->challenge_response, 0, sizeof(ctx->challenge_response));
+    memset(ctx->decryption_buffer, 0, sizeof(ctx->decryption_buffer));
     // set header and packet length of challenge response
-    xsm3_challenge_response[0] = 0x49;  // packet magic
-    xsm3_challenge_response[1] = 0x4C;
-    xsm3_challenge_response[4] = 0x28;  // packet length
+    ctx->challenge_response[0] = 0x49;  // packet magic
+    ctx->challenge_response[1] = 0x4C;
+    ctx->challenge_response[4] = 0x28;  // packet length
     // copy random controller, random console data to the encryption buffer
-    memcpy(xsm3_decryption_buffer, xsm3_random_controller_data, 0x10);
-    memcpy(xsm3_decryption_buffer + 0x10, xsm3_random_console_data, 0x10);
+    memcpy(ctx->decryption_buffer, ctx->random_controller_data, 0x10);
+    memcpy(ctx->decryption_buffer + 0x10, ctx->random_console_data, 0x10);
     // save the sha1 hash of the decrypted contents for later
-    ExCryptSha(xsm3_decryption_buffer, 0x20, NULL, 0, NULL, 0, xsm3_challenge_init_hash, 0x14);
+    ExCryptSha(ctx->decryption_buffer, 0x20, NULL, 0, NULL, 0, ctx->challenge_init_hash, 0x14);
 
     // encrypt challenge response packet using the encrypted random key
-    UsbdSecXSM3AuthenticationCrypt(xsm3_random_console_data_enc, xsm3_decryption_buffer, 0x20, xsm3_challenge_response + 0x5, 1);
+    UsbdSecXSM3AuthenticationCryptKey(&ctx->session_crypt_key, ctx->decryption_buffer, 0x20, ctx->challenge_response + 0x5, 1);
     // calculate MAC using the encrypted swapped random key and use it to calculate ACR
-    UsbdSecXSM3AuthenticationMac(xsm3_random_console_data_swap_enc, NULL, xsm3_challenge_response + 0x5, 0x20, response_packet_mac);
-    // calculate ACR and append to the end of the xsm3_challenge_response
-    UsbdSecXSMAuthenticationAcr(xsm3_console_id, xsm3_identification_data, response_packet_mac, xsm3_challenge_response + 0x5 + 0x20);
+    UsbdSecXSM3AuthenticationMacKey(&ctx->session_mac_key, NULL, ctx->challenge_response + 0x5, 0x20, response_packet_mac);
+    // calculate ACR and append to the end of the challenge response
+    UsbdSecXSMAuthenticationAcr(ctx->console_id, ctx->identification_data, response_packet_mac, ctx->challenge_response + 0x5 + 0x20);
     // calculate the checksum for the response packet
-    xsm3_challenge_response[0x5 + 0x28] = xsm3_calculate_checksum(xsm3_challenge_response);
+    ctx->challenge_response[0x5 + 0x28] = xsm3_calculate_checksum(ctx->challenge_response);
 
     // the console random value changes slightly after this point
-    memcpy(xsm3_random_console_data, xsm3_random_controller_data + 0xC, 0x4);
-    memcpy(xsm3_random_console_data + 0x4, xsm3_random_console_data + 0xC, 0x4);
+    memcpy(ctx->random_console_data, ctx->random_controller_data + 0xC, 0x4);
+    memcpy(ctx->random_console_data + 0x4, ctx->random_console_data + 0xC, 0x4);
 }
 
-void xsm3_do_challenge_verify(uint8_t challenge_packet[0x16]) {
+void xsm3_context_do_challenge_verify(Xsm3Context* ctx, const uint8_t challenge_packet[0x16]) {
     uint8_t incoming_packet_mac[0x8];
 
     // validate the checksum
@@ -237,28 +271,67 @@ void xsm3_do_challenge_verify(uint8_t challenge_packet[0x16]) {
     }
 
     // decrypt the packet using the controller generated random value
-    UsbdSecXSM3AuthenticationCrypt(xsm3_random_controller_data, challenge_packet + 0x5, 0x8, xsm3_decryption_buffer, 0);
+    UsbdSecXSM3AuthenticationCrypt(ctx->random_controller_data, challenge_packet + 0x5, 0x8, ctx->decryption_buffer, 0);
     // replace part of our random encryption value with the decrypted buffer
-    memcpy(xsm3_random_console_data + 0x8, xsm3_decryption_buffer, 0x8);
+    memcpy(ctx->random_console_data + 0x8, ctx->decryption_buffer, 0x8);
 
     // calculate the MAC of the incoming packet
-    UsbdSecXSM3AuthenticationMac(xsm3_challenge_init_hash, xsm3_random_console_data, challenge_packet + 0x5, 0x8, incoming_packet_mac);
+    UsbdSecXSM3AuthenticationMac(ctx->challenge_init_hash, ctx->random_console_data, (uint8_t*)challenge_packet + 0x5, 0x8, incoming_packet_mac);
     // validate the MAC
     if (memcmp(incoming_packet_mac, challenge_packet + 0x5 + 0x8, 0x8) != 0) {
         XSM3_printf("[ MAC failed when validating challenge verify! ]\n");
     }
     // clear response buffers
-    memset(xsm3_challenge_response, 0, sizeof(xsm3_challenge_response));
-    memset(xsm3_decryption_buffer, 0, sizeof(xsm3_decryption_buffer));
+    memset(ctx->challenge_response, 0, sizeof(ctx->challenge_response));
+    memset(ctx->decryption_buffer, 0, sizeof(ctx->decryption_buffer));
     // set header and packet length of challenge response
-    xsm3_challenge_response[0] = 0x49;  // packet magic
-    xsm3_challenge_response[1] = 0x4C;
-    xsm3_challenge_response[4] = 0x10;  // packet length
+    ctx->challenge_response[0] = 0x49;  // packet magic
+    ctx->challenge_response[1] = 0x4C;
+    ctx->challenge_response[4] = 0x10;  // packet length
     // calculate the ACR value and encrypt it into the outgoing packet using the encrypted random
-    UsbdSecXSMAuthenticationAcr(xsm3_console_id, xsm3_identification_data, xsm3_random_console_data + 0x8, xsm3_decryption_buffer);
-    UsbdSecXSM3AuthenticationCrypt(xsm3_random_console_data_enc, xsm3_decryption_buffer, 0x8, xsm3_challenge_response + 0x5, 1);
+    UsbdSecXSMAuthenticationAcr(ctx->console_id, ctx->identification_data, ctx->random_console_data + 0x8, ctx->decryption_buffer);
+    UsbdSecXSM3AuthenticationCryptKey(&ctx->session_crypt_key, ctx->decryption_buffer, 0x8, ctx->challenge_response + 0x5, 1);
     // calculate the MAC of the encrypted packet and append it to the end
-    UsbdSecXSM3AuthenticationMac(xsm3_random_console_data_swap_enc, xsm3_random_console_data, xsm3_challenge_response + 0x5, 0x8, xsm3_challenge_response + 0x5 + 0x8);
+    UsbdSecXSM3AuthenticationMacKey(&ctx->session_mac_key, ctx->random_console_data, ctx->challenge_response + 0x5, 0x8, ctx->challenge_response + 0x5 + 0x8);
     // calculate the checksum for the response packet
-    xsm3_challenge_response[0x5 + 0x10] = xsm3_calculate_checksum(xsm3_challenge_response);
-}
\ No newline at end of file
+    ctx->challenge_response[0x5 + 0x10] = xsm3_calculate_checksum(ctx->challenge_response);
+}
+
+// legacy API, backed by one shared context
+uint8_t xsm3_id_data_ms_controller[0x1D] = {
+    0x49, 0x4B, 0x00, 0x00, 0x17, 0x41, 0x41, 0x41,
+    0x41, 0x41, 0x41, 0x41, 0x41, 0x41, 0x41, 0x41,
+    0x00, 0x00, 0x80, 0x02, 0x09, 0x12, 0x82, 0x28,
+    0x03, 0x00, 0x01, 0x01, 0x71};
+uint8_t xsm3_challenge_response[0x30];
+uint8_t xsm3_console_id[0x8];
+
+static Xsm3Context xsm3_shared_context;
+
+static void xsm3_publish_shared(void) {
+    memcpy(xsm3_challenge_response, xsm3_shared_context.challenge_response, sizeof(xsm3_challenge_response));
+    memcpy(xsm3_console_id, xsm3_shared_context.console_id, sizeof(xsm3_console_id));
+}
+
+void xsm3_initialise_state() {
+    xsm3_clear_state(&xsm3_shared_context);
+    xsm3_publish_shared();
+}
+
+void xsm3_set_vid_pid(const uint8_t serial[0x0C], uint16_t vid, uint16_t pid) {
+    xsm3_write_vid_pid(xsm3_id_data_ms_controller, serial, vid, pid);
+}
+
+void xsm3_set_identification_data(const uint8_t id_data[0x1D]) {
+    xsm3_context_set_identification_data(&xsm3_shared_context, id_data);
+}
+
+void xsm3_do_challenge_init(uint8_t challenge_packet[0x22]) {
+    xsm3_context_do_challenge_init(&xsm3_shared_context, challenge_packet);
+    xsm3_publish_shared();
+}
+
+void xsm3_do_challenge_verify(uint8_t challenge_packet[0x16]) {
+    xsm3_context_do_challenge_verify(&xsm3_shared_context, challenge_packet);
+    xsm3_publish_shared();
+}
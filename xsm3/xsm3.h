@@ -23,10 +23,79 @@
 #include <stdint.h>
 #include <stddef.h>
 #include <stdbool.h>
+#include "usbdsec.h"
 #ifdef __cplusplus
 extern "C" {
 #endif
+#define XSM3_KEY_CACHE_SIZE 4
+
+// Keys derived from a console ID, which never changes for a given console.
+typedef struct {
+    uint8_t console_id[0x8];
+    uint8_t kv_2des_key_1[0x10];
+    uint8_t kv_2des_key_2[0x10];
+    uint32_t last_used;  // 0 = empty
+} Xsm3KeyCacheEntry;
+
+// Least recently used cache of derived keys, plain data so it can be saved as is.
+typedef struct {
+    Xsm3KeyCacheEntry entries[XSM3_KEY_CACHE_SIZE];
+    uint32_t clock;
+    bool dirty;  // set when an entry was added since the last xsm3_key_cache_init / load
+} Xsm3KeyCache;
+
+// Empties the cache.
+void xsm3_key_cache_init(Xsm3KeyCache* cache);
+
+// All the state of one handshake, so several can run at once.
+typedef struct {
+    // Identification packet sent in reply to request 0x81.
+    uint8_t id_data[0x1D];
+    // The response data from the previously completed challenge.
+    uint8_t challenge_response[0x30];
+    // The console ID fetched from the console after request 0x82.
+    uint8_t console_id[0x8];
+
+    uint8_t kv_2des_key_1[0x10];
+    uint8_t kv_2des_key_2[0x10];
+    uint8_t decryption_buffer[0x30];
+    uint8_t identification_data[0x20];
+    uint8_t random_console_data[0x10];
+    uint8_t random_console_data_enc[0x10];
+    uint8_t random_console_data_swap[0x10];
+    uint8_t random_console_data_swap_enc[0x10];
+    uint8_t random_controller_data[0x10];
+    uint8_t challenge_init_hash[0x14];
+    // Schedules for random_console_data_enc / _swap_enc, used by both init and verify.
+    UsbdSecKey session_crypt_key;
+    UsbdSecKey session_mac_key;
+
+    // Optional, skips the key derivation for consoles seen before.
+    Xsm3KeyCache* key_cache;
+} Xsm3Context;
+
+// Clears the handshake state and resets id_data to the official controller's. Leaves no key cache set.
+void xsm3_context_init(Xsm3Context* ctx);
+
+// Rewrites id_data with the given serial number, vendor and product ID.
+void xsm3_context_set_vid_pid(Xsm3Context* ctx, const uint8_t serial[0x0C], uint16_t vid, uint16_t pid);
+
+// Uses the given key cache for this context, NULL to always derive the keys.
+void xsm3_context_set_key_cache(Xsm3Context* ctx, Xsm3KeyCache* cache);
+
+// Sets the identification data to use.
+void xsm3_context_set_identification_data(Xsm3Context* ctx, const uint8_t id_data[0x1D]);
+
+// Initialises the handshake using the challenge init packet (0x82) and places a response in ctx->challenge_response.
+void xsm3_context_do_challenge_init(Xsm3Context* ctx, const uint8_t challenge_packet[0x22]);
+
+// Completes a verify challenge passed from request 0x87 and places the response data in ctx->challenge_response.
+void xsm3_context_do_challenge_verify(Xsm3Context* ctx, const uint8_t challenge_packet[0x16]);
+
+// Legacy API, working on a single shared context.
+
 // Identification data taken from an official wired controller. (Serial number is static.)
+// xsm3_set_vid_pid updates this in place, contexts keep their own copy in id_data.
 extern uint8_t xsm3_id_data_ms_controller[0x1D];
 
 // The response data from the previously completed challenge.
@@ -47,6 +116,7 @@ void xsm3_do_challenge_init(uint8_t challenge_packet[0x22]);
 // Completes a verify challenge passed from request 0x87 and places the response data in xsm3_challenge_response.
 void xsm3_do_challenge_verify(uint8_t challenge_packet[0x16]);
 
+// Writes the serial number, vendor and product ID into xsm3_id_data_ms_controller.
 void xsm3_set_vid_pid(const uint8_t serial[0x0C], uint16_t vid, uint16_t pid);
 #ifdef __cplusplus
 }